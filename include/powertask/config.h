@@ -0,0 +1,83 @@
+#ifndef POWERTASK_CONFIG_H
+#define POWERTASK_CONFIG_H
+
+#include <limits.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * @brief Build profile
+ *
+ * @details The default profile favours simplicity. Defining
+ * POWERTASK_CONFIG_MINIMAL selects the minimal-footprint profile, meant for
+ * nodes where RAM and stack headroom limit the number of tasks:
+ *
+ * - energies and counters use narrow integer types;
+ * - the task description (action, condition, energy, resource and source) is
+ *   kept in a const table, so only the task id and completion flag use RAM;
+ * - schedulers not created with POWERTASK_INIT() build the stored state in a
+ *   static buffer sized for POWERTASK_CONFIG_MAX_TASKS, instead of the stack.
+ *
+ * Each option can also be overridden on its own.
+ */
+
+#ifdef POWERTASK_CONFIG_MINIMAL
+
+#ifndef POWERTASK_CONFIG_MAX_TASKS
+#define POWERTASK_CONFIG_MAX_TASKS 32
+#endif
+
+#if POWERTASK_CONFIG_MAX_TASKS > 255
+#error "POWERTASK_CONFIG_MAX_TASKS does not fit powertask_count_t in the minimal profile"
+#endif
+
+#ifndef POWERTASK_CONFIG_CONST_TASKS
+#define POWERTASK_CONFIG_CONST_TASKS 1
+#endif
+
+#ifndef POWERTASK_CONFIG_STATIC_STATE
+#define POWERTASK_CONFIG_STATIC_STATE 1
+#endif
+
+/** @brief Energy (in uJ). Limits required and setup energies to 65535. */
+typedef uint16_t powertask_energy_t;
+
+/** @brief Task count or index. Limits schedulers to 255 tasks. */
+typedef uint8_t powertask_count_t;
+
+/** @brief Maximum value of powertask_count_t. */
+#define POWERTASK_COUNT_MAX UINT8_MAX
+
+#else
+
+/** @brief Maximum number of tasks whose state can be stored. */
+#ifndef POWERTASK_CONFIG_MAX_TASKS
+#define POWERTASK_CONFIG_MAX_TASKS 255
+#endif
+
+/** @brief Keep the task description in a const table instead of RAM. */
+#ifndef POWERTASK_CONFIG_CONST_TASKS
+#define POWERTASK_CONFIG_CONST_TASKS 0
+#endif
+
+/**
+ * @brief Use a static buffer for the stored state instead of the stack.
+ *
+ * @note Schedulers must then not run concurrently from different threads.
+ */
+#ifndef POWERTASK_CONFIG_STATIC_STATE
+#define POWERTASK_CONFIG_STATIC_STATE 0
+#endif
+
+/** @brief Energy (in uJ). */
+typedef int powertask_energy_t;
+
+/** @brief Task count or index. */
+typedef int powertask_count_t;
+
+/** @brief Maximum value of powertask_count_t. */
+#define POWERTASK_COUNT_MAX INT_MAX
+
+#endif /* POWERTASK_CONFIG_MINIMAL */
+
+#endif /* POWERTASK_CONFIG_H */
@@ -1,20 +1,115 @@
 #ifndef POWERTASK_ENERGY_H
 #define POWERTASK_ENERGY_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @brief Filter applied to voltage samples */
+typedef enum powertask_filter_e {
+    POWERTASK_FILTER_NONE,   /**< Single raw sample. */
+    POWERTASK_FILTER_MEDIAN, /**< Median of a batch of samples. Rejects load transients and ADC spikes. */
+    POWERTASK_FILTER_EWMA,   /**< Exponentially weighted moving average. One conversion per read. */
+} powertask_filter_t;
+
+/** @brief Largest EWMA smoothing factor. Keeps the scaled state of a 16-bit voltage within an int. */
+#define POWERTASK_SAMPLER_MAX_EWMA_SHIFT 15
+
+/** @brief Voltage sampling stage */
+typedef struct powertask_sampler_s {
+    int (*read_samples)(int *buffer, size_t number_of_samples); /**< Function to fill a buffer with voltage samples (in mV), e.g. through DMA. Returns 0 if successful. */
+    int *buffer;               /**< Buffer where the batch of samples is written. */
+    size_t buffer_len;         /**< Number of samples taken per read by the median filter. */
+    powertask_filter_t filter; /**< Filter applied to the samples. */
+    int ewma_shift;            /**< EWMA smoothing factor as a power of two (alpha = 1 / 2^ewma_shift), up to POWERTASK_SAMPLER_MAX_EWMA_SHIFT. */
+    int hysteresis;            /**< Hysteresis band (in mV). Filtered changes within the band are not reported. */
+    int _ewma;                 /**< EWMA state (in mV), scaled by 2^ewma_shift so that no precision is lost. */
+    int _filtered;             /**< Current filter output (in mV). */
+    int _reported;             /**< Last reported voltage (in mV). */
+    bool _primed;              /**< Indicates if the filter output and reported voltage are valid. */
+} powertask_sampler_t;
+
 /** @brief Energy source */
 typedef struct powertask_energy_source_s {
     int capacitance; /**< Capacitance (in uF) of the energy source. */
     int (*get_voltage)(void); /**< Function to measure voltage (in mV) on the energy source. */
+    powertask_sampler_t *sampler; /**< Optional sampling stage. If NULL, get_voltage is read directly. */
 } powertask_energy_source_t; 
 
+/**
+ * @brief Initializes a voltage sampling stage
+ *
+ * @details Validates the sampler parameters and clears the filter state, so
+ * the next read primes the filter again.
+ *
+ * @param[in] sampler Sampler structure
+ *
+ * @return 0, if successful
+ * @return -EINVAL \p sampler is NULL, the median filter has no buffer or
+ * ewma_shift is negative or above POWERTASK_SAMPLER_MAX_EWMA_SHIFT.
+ */
+int powertask_sampler_init(powertask_sampler_t *sampler);
+
+/**
+ * @brief Gets the current voltage on the energy source
+ *
+ * @details When the energy source has a sampler, the samples go through its
+ * filter and hysteresis band. Only the conversions needed by the filter are
+ * requested: one for POWERTASK_FILTER_NONE and POWERTASK_FILTER_EWMA and
+ * buffer_len for POWERTASK_FILTER_MEDIAN.
+ *
+ * @param[in] energy_source Energy source structure
+ *
+ * @retval If positive, the voltage (in mV) on the energy source.
+ * @retval -EINVAL \p energy_source is NULL or contains invalid parameter values.
+ * @retval -EIO Reading the samples failed.
+ */
+int powertask_get_voltage(powertask_energy_source_t *energy_source);
+
 /** 
  * @brief Gets current available amount of energy  
  * 
+ * @details E = C * V^2 / 2, with the capacitance in uF and the voltage in mV,
+ * gives the energy in uJ. All energies in the library use this unit.
+ * 
  * @param[in] energy_source Energy source structure
  * 
- * @retval If positive, the amount of available energy in joules.
+ * @retval If positive, the amount of available energy in uJ.
  * @retval -EINVAL \p energy_source is NULL or contains invalid parameter values.
+ * @retval -EIO Reading the voltage failed.
  */
 int powertask_get_available_energy(powertask_energy_source_t *energy_source);
 
+/**
+ * @brief Gets the voltage at which an amount of energy becomes available
+ * 
+ * @details Inverse of powertask_get_available_energy(). Useful to arm voltage
+ * comparators that wake the system up once enough energy has been harvested.
+ * 
+ * @param[in] energy_source Energy source structure
+ * @param[in] energy        Amount of energy in uJ.
+ * 
+ * @retval If positive, the lowest voltage (in mV) at which more than \p energy
+ * is available.
+ * @retval -EINVAL \p energy_source is NULL, contains invalid parameter values or
+ * \p energy is negative.
+ */
+int powertask_get_voltage_for_energy(powertask_energy_source_t *energy_source, int energy);
+
+/**
+ * @brief Admission rule
+ * 
+ * @details A task is admitted if the available energy is above the energy it
+ * requires (including resource setup and reserved energy). Shared by the
+ * scheduler, the energy pools and the fleet simulation.
+ * 
+ * @param[in] available_energy Available energy (in uJ).
+ * @param[in] required_energy  Energy (in uJ) required by the task.
+ * 
+ * @return true if the task is admitted.
+ */
+static inline bool powertask_admit(int available_energy, int required_energy)
+{
+    return available_energy > required_energy;
+}
+
 #endif /* POWERTASK_ENERGY_H */
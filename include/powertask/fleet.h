@@ -0,0 +1,127 @@
+#ifndef POWERTASK_FLEET_H
+#define POWERTASK_FLEET_H
+
+#include <stdint.h>
+
+/** @brief Maximum number of tasks of a fleet. The complete tasks of a node are a 32-bit set. */
+#define POWERTASK_FLEET_MAX_TASKS 32
+
+/** @brief Maximum learning shift. Larger shifts would not fit the 32-bit costs. */
+#define POWERTASK_FLEET_MAX_LEARNING_SHIFT 30
+
+/** @brief Task run by every node of a fleet */
+typedef struct powertask_fleet_task_s {
+    int required_energy; /**< Required energy (in uJ) to run the task. */
+    int cost;            /**< Energy (in uJ) spent by the task, on every node unless changed after init. */
+    uint32_t wait_for;   /**< Set of tasks (bit i for task i) that must be complete before the task runs. */
+} powertask_fleet_task_t;
+
+/**
+ * @brief Batch of simulated nodes
+ *
+ * @details Every node runs the same task set against its own harvest, as a
+ * scheduler running once per step. The nodes are stored as a struct of arrays,
+ * so a step goes through each array sequentially. Per task arrays are indexed
+ * by POWERTASK_FLEET_INDEX().
+ *
+ * Energies are above the brownout level of the nodes: a node browns out if a
+ * task spends more than the stored energy.
+ *
+ * Only part of the scheduler is modelled. Left out are:
+ * - energy reservations and aging: every task is admitted on its own required
+ *   energy, so cheap tasks are never held back for an expensive one;
+ * - resources: there is no setup energy and no powered window;
+ * - conditions other than wait_for, energy pools and task submissions.
+ *
+ * A node therefore behaves as a scheduler with aging_threshold 0 whose tasks
+ * have no reserved energy, no resource and POWERTASK_RUN_ALWAYS conditions.
+ */
+typedef struct powertask_fleet_s {
+    const powertask_fleet_task_t *tasks; /**< Task set, in scheduling order. */
+    int number_of_tasks;                 /**< Number of tasks (at most POWERTASK_FLEET_MAX_TASKS). */
+    int number_of_nodes;                 /**< Number of nodes. */
+    int max_energy;                      /**< Energy (in uJ) stored by a full node. Harvest above it is lost. 0 if unlimited. */
+    int learning_shift;                  /**< Learned costs move by 1/2^learning_shift of the error. 0 admits tasks by their required energy. At most POWERTASK_FLEET_MAX_LEARNING_SHIFT. */
+    int32_t *energy;                     /**< Energy stored by each node. */
+    uint32_t *complete;                  /**< Set of complete tasks of each node. */
+    int32_t *cost;                       /**< Energy spent by each task on each node. */
+    int32_t *learned_cost;               /**< Energy each node learned each task spends. Used for admission if learning. */
+    uint32_t *rounds;                    /**< Number of rounds completed by each node. */
+    uint32_t *brownouts;                 /**< Number of brownouts of each node. */
+    uint32_t *_stored;                   /**< Stored set of complete tasks of each node, restored on brownout. */
+} powertask_fleet_t;
+
+/**
+ * @brief Index of the element of a task and node in the per task arrays
+ *
+ * @param[in] _fleet Fleet instance
+ * @param[in] _task  Index of the task.
+ * @param[in] _node  Index of the node.
+ */
+#define POWERTASK_FLEET_INDEX(_fleet, _task, _node) ((_task) * (_fleet)->number_of_nodes + (_node))
+
+/**
+ * @brief Initialize fleet
+ *
+ * @param[in] _name             Name to be given to the fleet.
+ * @param[in] _tasks            Task set run by every node.
+ * @param[in] _number_of_tasks  Number of tasks in the task set.
+ * @param[in] _number_of_nodes  Number of nodes.
+ */
+#define POWERTASK_FLEET_INIT(_name, _tasks, _number_of_tasks, _number_of_nodes)  \
+    static int32_t _name##_energy[_number_of_nodes];                              \
+    static uint32_t _name##_complete[_number_of_nodes];                           \
+    static int32_t _name##_cost[(_number_of_tasks) * (_number_of_nodes)];        \
+    static int32_t _name##_learned_cost[(_number_of_tasks) * (_number_of_nodes)]; \
+    static uint32_t _name##_rounds[_number_of_nodes];                             \
+    static uint32_t _name##_brownouts[_number_of_nodes];                          \
+    static uint32_t _name##_stored[_number_of_nodes];                             \
+    static powertask_fleet_t _name = {                                            \
+        .tasks = _tasks,                                                          \
+        .number_of_tasks = _number_of_tasks,                                      \
+        .number_of_nodes = _number_of_nodes,                                      \
+        .energy = _name##_energy,                                                 \
+        .complete = _name##_complete,                                             \
+        .cost = _name##_cost,                                                     \
+        .learned_cost = _name##_learned_cost,                                     \
+        .rounds = _name##_rounds,                                                 \
+        .brownouts = _name##_brownouts,                                           \
+        ._stored = _name##_stored,                                                \
+}
+
+/**
+ * @brief Reset the nodes of a fleet
+ *
+ * @details Nodes start empty with no complete tasks. Costs are set to the
+ * cost of the tasks and learned costs to their required energy.
+ *
+ * @param[in] fleet Fleet instance
+ *
+ * @return 0, if successful
+ * @return -EINVAL \p fleet is NULL, has too many tasks, an invalid learning
+ * shift or is missing an array.
+ */
+int powertask_fleet_init(powertask_fleet_t *fleet);
+
+/**
+ * @brief Advance every node of a fleet by one step
+ *
+ * @details Each node harvests energy and runs its pending tasks in order, with
+ * the admission rule of the scheduler (powertask_admit()). A task runs if it is
+ * pending, admitted and the tasks it waits for are complete. If it spends more
+ * than the stored energy, the node browns out: its complete tasks are restored
+ * to the stored ones and nothing else runs in the step. Nodes that completed
+ * every task start a new round.
+ *
+ * If learning, each task executed moves the learned cost of the node towards
+ * the energy actually spent. Learned costs are kept across brownouts.
+ *
+ * @param[in] fleet   Fleet instance
+ * @param[in] harvest Energy harvested by each node in this step. NULL if none.
+ *
+ * @retval Number of tasks executed in the fleet.
+ * @retval -EINVAL \p fleet is NULL.
+ */
+int powertask_fleet_step(powertask_fleet_t *fleet, const int32_t *harvest);
+
+#endif /* POWERTASK_FLEET_H */
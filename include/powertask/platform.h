@@ -0,0 +1,41 @@
+#ifndef POWERTASK_PLATFORM_H
+#define POWERTASK_PLATFORM_H
+
+#include <stdbool.h>
+#include <powertask/energy.h>
+#include <powertask/scheduler.h>
+
+/** @brief Platform hooks used by the run forever loop */
+typedef struct powertask_platform_s {
+    void (*sleep)(void);                      /**< Enters low power mode until an armed wakeup occurs. */
+    int (*set_voltage_wakeup)(int threshold); /**< Arms a wakeup once the voltage (in mV) rises above threshold. Optional. */
+    int (*set_timer_wakeup)(int timeout);     /**< Arms a wakeup after timeout (in ms). */
+    int idle_timeout;                         /**< Timeout (in ms) to wait for when tasks are blocked on their conditions. */
+    bool (*keep_running)(void);               /**< Returns false to leave the loop. Optional, if NULL the loop never returns. */
+} powertask_platform_t;
+
+/**
+ * @brief Runs the scheduler forever
+ * 
+ * @details The first pass is run right away, as it loads the stored state that
+ * tells which tasks are pending. The scheduler is then run again right away
+ * while it makes progress. When
+ * no task can be executed, the loop sleeps until it can: if there is not enough
+ * energy for the cheapest pending task (plus the energy reserved by another
+ * task, see powertask_get_cheapest_pending_energy()), a voltage wakeup is
+ * armed at the threshold where a task becomes affordable and no pass is run
+ * until then. Otherwise, the pending tasks are waiting on their conditions and
+ * a timer wakeup is armed.
+ * 
+ * @param[in] sched         Scheduler instance
+ * @param[in] energy_source Energy source used to run scheduled tasks
+ * @param[in] platform      Platform hooks
+ * 
+ * @retval 0 \p platform requested the loop to stop.
+ * @retval -EINVAL One or more parameters are NULL or \p platform is missing
+ * mandatory hooks.
+ */
+int powertask_run_forever(powertask_scheduler *sched, powertask_energy_source_t *energy_source,
+                          powertask_platform_t *platform);
+
+#endif /* POWERTASK_PLATFORM_H */
@@ -0,0 +1,67 @@
+#ifndef POWERTASK_POOL_H
+#define POWERTASK_POOL_H
+
+#include <powertask/energy.h>
+
+/** @brief Policy used to pick the source a task draws energy from */
+typedef enum powertask_pool_policy_e {
+    POWERTASK_POOL_PREFERRED, /**< Task's preferred source if it has enough energy, otherwise the first one that has. */
+    POWERTASK_POOL_STRICT,    /**< Only the task's preferred source. */
+    POWERTASK_POOL_COMBINED,  /**< Sources share the supply rail. Tasks are admitted against the sum of the sources. */
+} powertask_pool_policy_t;
+
+/** @brief Energy source within a pool */
+typedef struct powertask_pool_source_s {
+    powertask_energy_source_t *energy_source; /**< Energy source. */
+    int reserve_energy;                       /**< Energy (in uJ) that cannot be drawn, e.g. below the regulator cut-off. */
+    int efficiency;                           /**< Efficiency (in %) of the conversion from the source to the load. 0 means 100%. */
+    void (*select)(void);                     /**< Routes the supply to this source. Optional. */
+} powertask_pool_source_t;
+
+/** @brief Energy pool combining several sources (e.g. a supercapacitor and a battery) */
+typedef struct powertask_energy_pool_s {
+    powertask_pool_source_t *sources; /**< Sources in the pool. */
+    int number_of_sources;            /**< Number of sources in the pool. */
+    powertask_pool_policy_t policy;   /**< Policy used to pick the source a task draws from. */
+} powertask_energy_pool_t;
+
+/**
+ * @brief Gets the energy that can be drawn from a source of the pool
+ * 
+ * @details The available energy of the source minus its reserve, scaled by the
+ * conversion efficiency.
+ * 
+ * @param[in] pool   Energy pool
+ * @param[in] source Index of the source in the pool.
+ * 
+ * @retval If positive, the amount of usable energy in uJ.
+ * @retval -EINVAL \p pool is NULL or \p source is out of range.
+ * @retval negative value, if reading the source failed.
+ */
+int powertask_pool_get_usable_energy(powertask_energy_pool_t *pool, int source);
+
+/**
+ * @brief Gets the energy that can be drawn from all the sources of the pool
+ * 
+ * @param[in] pool Energy pool
+ * 
+ * @retval If positive, the combined amount of usable energy in uJ.
+ * @retval -EINVAL \p pool is NULL or has no sources.
+ */
+int powertask_pool_get_available_energy(powertask_energy_pool_t *pool);
+
+/**
+ * @brief Picks the source a task draws energy from
+ * 
+ * @param[in] pool            Energy pool
+ * @param[in] preferred       Index of the source preferred by the task.
+ * @param[in] required_energy Energy (in uJ) required by the task.
+ * 
+ * @retval If positive, index of the source with more than \p required_energy
+ * usable, according to the pool policy.
+ * @retval -ENOENT No source can supply \p required_energy.
+ * @retval -EINVAL \p pool is NULL or has no sources.
+ */
+int powertask_pool_select(powertask_energy_pool_t *pool, int preferred, int required_energy);
+
+#endif /* POWERTASK_POOL_H */
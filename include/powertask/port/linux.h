@@ -0,0 +1,38 @@
+#ifndef POWERTASK_PORT_LINUX_H
+#define POWERTASK_PORT_LINUX_H
+
+#include <powertask/platform.h>
+
+/**
+ * @brief Initialize the Linux reference port
+ * 
+ * @details Sleep is implemented by waiting on a timerfd, for timer wakeups, and
+ * on an eventfd, for voltage wakeups. Voltage is reported to the port through
+ * powertask_linux_notify_voltage(), e.g. by a thread simulating the harvester.
+ * 
+ * @param[out] platform Platform hooks to be filled in.
+ * 
+ * @return 0, if successful
+ * @return negative value, otherwise
+ */
+int powertask_linux_init(powertask_platform_t *platform);
+
+/**
+ * @brief Release the resources used by the Linux reference port
+ */
+void powertask_linux_deinit(void);
+
+/**
+ * @brief Report the current voltage to the Linux reference port
+ * 
+ * @details Wakes up the sleeping loop if the voltage is above the armed
+ * threshold. Safe to call from other threads.
+ * 
+ * @param[in] voltage Current voltage (in mV) on the energy source.
+ * 
+ * @return 0, if successful
+ * @return negative value, otherwise
+ */
+int powertask_linux_notify_voltage(int voltage);
+
+#endif /* POWERTASK_PORT_LINUX_H */
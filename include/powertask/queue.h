@@ -0,0 +1,67 @@
+#ifndef POWERTASK_QUEUE_H
+#define POWERTASK_QUEUE_H
+
+struct powertask_task_s;
+
+/** @brief Slot of a submission queue */
+typedef struct powertask_queue_slot_s {
+    unsigned int _sequence;        /**< Slot sequence, relative to the slot index so that zero is the initial state. */
+    struct powertask_task_s *task; /**< Submitted task. */
+} powertask_queue_slot_t;
+
+/**
+ * @brief Bounded lock-free submission queue
+ * 
+ * @details Multiple producers (threads or interrupt handlers) and a single
+ * consumer (the scheduler). Producers never block nor disable interrupts: a
+ * push either claims a slot with a compare-and-swap or fails when the queue is
+ * full. Requires lock-free atomic operations on unsigned int.
+ */
+typedef struct powertask_queue_s {
+    powertask_queue_slot_t *slots; /**< Queue slots. */
+    unsigned int capacity;         /**< Number of slots. Must be a power of two. */
+    unsigned int _head;            /**< Position of the next push. Shared by the producers. */
+    unsigned int _tail;            /**< Position of the next pop. Owned by the consumer. */
+} powertask_queue_t;
+
+/**
+ * @brief Initialize submission queue
+ * 
+ * @param[in] _name     Name to be given to the queue.
+ * @param[in] _capacity Number of slots in the queue. Must be a power of two.
+ */
+#define POWERTASK_QUEUE_INIT(_name, _capacity)                                          \
+    enum { _name##_capacity_is_power_of_two = 1 / (((_capacity) & ((_capacity) - 1)) == 0) }; \
+    static powertask_queue_slot_t _name##_slots[_capacity];                             \
+    static powertask_queue_t _name = {                                                  \
+        .slots = _name##_slots,                                                         \
+        .capacity = _capacity,                                                          \
+}
+
+/**
+ * @brief Push a task into the queue
+ * 
+ * @details Safe to call from interrupt handlers and concurrent threads.
+ * 
+ * @param[in] queue Queue instance
+ * @param[in] task  Task to be pushed.
+ * 
+ * @return 0, if successful
+ * @return -ENOSPC the queue is full.
+ * @return -EINVAL \p queue or \p task is NULL, or the queue capacity is not a
+ * power of two.
+ */
+int powertask_queue_push(powertask_queue_t *queue, struct powertask_task_s *task);
+
+/**
+ * @brief Pop a task from the queue
+ * 
+ * @details Must only be called by the consumer.
+ * 
+ * @param[in] queue Queue instance
+ * 
+ * @return Oldest task in the queue, or NULL if the queue is empty.
+ */
+struct powertask_task_s *powertask_queue_pop(powertask_queue_t *queue);
+
+#endif /* POWERTASK_QUEUE_H */
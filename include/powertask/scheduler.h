@@ -1,51 +1,323 @@
 #ifndef POWERTASK_SCHEDULER_H
 #define POWERTASK_SCHEDULER_H
 
+#include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <powertask/config.h>
 #include <powertask/energy.h>
+#include <powertask/pool.h>
+#include <powertask/queue.h>
+
+#ifdef POWERTASK_CONFIG_TRACE
+#include <powertask/trace.h>
+#endif
+
+/** @brief Resource shared by tasks (e.g. radio, sensor or flash chip) */
+typedef struct powertask_resource_s {
+    void (*setup)(void);             /**< Powers up the resource. */
+    void (*teardown)(void);          /**< Powers down the resource. */
+    powertask_energy_t setup_energy; /**< Energy (in uJ) spent powering the resource up and down. */
+    bool _powered;                   /**< Indicates if the resource is currently powered. */
+} powertask_resource;
+
+#if POWERTASK_CONFIG_CONST_TASKS
+
+/** @brief Task description, kept in a const table */
+typedef struct powertask_task_info_s {
+    void (*action)(void);               /**< Action to be executed. */
+    bool (*condition)(void);            /**< Condition that allows execution of the task. Must not have side effects. */
+    powertask_energy_t required_energy; /**< Required energy (in uJ) to run the task. */
+    powertask_energy_t reserved_energy; /**< Energy (in uJ) other tasks may not use while the task is pending. 0 if none. */
+    powertask_resource *resource;       /**< Resource used by the task. NULL if none. */
+    powertask_count_t source;           /**< Index of the pool source preferred by the task. */
+} powertask_task_info;
+
+/** @brief Task */
+typedef struct powertask_task_s {
+    const powertask_task_info *info; /**< Task description. */
+    uint32_t id : 31;                /**< Stable identifier used to match the task with its stored state. 0 if none. */
+    uint32_t complete : 1;           /**< Indicates if the task was already executed. */
+    powertask_count_t _age;          /**< Number of runs the task was skipped for lack of energy. */
+} powertask_task;
+
+/** @brief Description of a task. */
+#define POWERTASK_TASK_INFO(_task) ((_task)->info)
+
+#else
 
 /** @brief Task */
 typedef struct powertask_task_s {
-    void (*action)(void);    /**< Action to be executed. */
-    bool (*condition)(void); /**< Condition that allows execution of the task. */
-    int required_energy;     /**< Required energy (in Joules) to run the task. */
-    bool complete;           /**< Indicates if the task was already executed. */
+    void (*action)(void);               /**< Action to be executed. */
+    bool (*condition)(void);            /**< Condition that allows execution of the task. Must not have side effects. */
+    powertask_energy_t required_energy; /**< Required energy (in uJ) to run the task. */
+    powertask_energy_t reserved_energy; /**< Energy (in uJ) other tasks may not use while the task is pending. 0 if none. */
+    powertask_resource *resource;       /**< Resource used by the task. NULL if none. */
+    powertask_count_t source;           /**< Index of the pool source preferred by the task. */
+    bool complete;                      /**< Indicates if the task was already executed. */
+    powertask_count_t _age;             /**< Number of runs the task was skipped for lack of energy. */
+    uint32_t id;                        /**< Stable identifier used to match the task with its stored state. 0 if none. */
 } powertask_task;
 
+/** @brief Task description. Part of the task itself in this profile. */
+typedef powertask_task powertask_task_info;
+
+/** @brief Description of a task. */
+#define POWERTASK_TASK_INFO(_task) (_task)
+
+#endif /* POWERTASK_CONFIG_CONST_TASKS */
+
 /** @brief Scheduler */
 typedef struct powertask_scheduler_s {
-    powertask_task **list_of_tasks; /**< List with scheduled tasks. */
-    int number_of_tasks;            /**< Current number of scheduled tasks in the list. */
-    int _list_of_tasks_len;         /**< Maximum number of tasks allowed in the list. */
+    powertask_task **list_of_tasks;        /**< List with scheduled tasks. */
+    powertask_count_t number_of_tasks;     /**< Current number of scheduled tasks in the list. */
+    powertask_count_t _list_of_tasks_len;  /**< Maximum number of tasks allowed in the list. */
+    powertask_count_t _pending_tasks;      /**< Number of tasks not yet executed in the current round. */
+    powertask_count_t _cheapest_task;      /**< Position in _tasks_by_cost before which all tasks are complete. */
+    uint32_t _state_marker;                /**< Marks the task states in RAM as valid. Cleared by a reset or power loss. */
+    uint32_t *_state_buffer;               /**< Buffer of POWERTASK_STATE_SIZE(_list_of_tasks_len) bytes where the stored state is built. NULL to use a fallback buffer. */
+    powertask_count_t *_tasks_by_cost;     /**< Indexes of the tasks, sorted by required energy (including resource setup). */
+    powertask_queue_t *submissions;        /**< Queue of task activations, drained at the start of each run. NULL if none. */
+    uint32_t _dropped_submissions;         /**< Activations of tasks that did not fit in the list. */
+    powertask_count_t aging_threshold;     /**< Runs a task may be skipped for lack of energy before it reserves its energy. 0 disables aging. */
+    powertask_task *_reserving_task;       /**< Task holding the energy reservation of the last run. NULL if none. */
+#ifdef POWERTASK_CONFIG_TRACE
+    powertask_trace_t *trace;              /**< Persistent trace of the scheduler events. NULL if not traced. */
+#endif
 } powertask_scheduler;
 
+/** @brief RAM (in bytes) used by each task. */
+#define POWERTASK_TASK_RAM_SIZE sizeof(powertask_task)
+
+/**
+ * @brief Size (in bytes) of the stored scheduler state
+ * 
+ * @details Schedulers created with POWERTASK_INIT() build the state in a buffer
+ * of this size for their maximum number of tasks. Other schedulers use a
+ * fallback buffer for POWERTASK_CONFIG_MAX_TASKS tasks, on the stack or static
+ * if POWERTASK_CONFIG_STATIC_STATE is set.
+ * 
+ * @param[in] _number_of_tasks Number of tasks of the scheduler.
+ */
+#define POWERTASK_STATE_SIZE(_number_of_tasks) ((2 + (_number_of_tasks)) * sizeof(uint32_t))
+
+/**
+ * @brief RAM (in bytes) used by a scheduler, excluding its tasks
+ * 
+ * @param[in] _number_of_tasks Maximum number of tasks allowed on the scheduler.
+ */
+#define POWERTASK_SCHEDULER_RAM_SIZE(_number_of_tasks)                                                       \
+    (sizeof(powertask_scheduler) + (_number_of_tasks) * (sizeof(powertask_task *) + sizeof(powertask_count_t)) + \
+     POWERTASK_STATE_SIZE(_number_of_tasks))
+
 /**
  * @brief Runs the scheduled tasks 
  * 
+ * @details Runnable tasks that share a resource are executed in a single
+ * powered window, at the position of the first task using that resource. The
+ * resource setup energy is only accounted for in the admission of the task that
+ * powers the resource up.
+ * 
+ * A pending task reserves energy if it has a reserved energy, or if it was
+ * skipped for lack of energy in at least aging_threshold runs (then reserving
+ * its own required energy, including resource setup). In each run, the reserving task whose condition
+ * holds and that waited the longest holds the reservation: the other tasks are
+ * only admitted if the available energy exceeds their required energy plus the
+ * reserved energy. The age of the holder does not grow, so tasks it holds back
+ * eventually take over the reservation.
+ * 
+ * The condition of the holder is only called when the reservation is made.
+ * Other reserving tasks may have their condition called again when they are
+ * reached, so conditions must not have side effects.
+ * 
+ * The available energy is read once per run, and read again only after an
+ * action was executed, so a filtered read (see powertask_sampler_t) is not
+ * repeated for every skipped task.
+ * 
  * @param[in] sched Scheduler instance
  * @param[in] energy_source Energy source used to run scheduled tasks 
+ * 
+ * @retval Number of tasks executed during this run.
+ * @retval -EINVAL \p sched or \p energy_source is NULL.
  */
-void powertask_run_scheduler(powertask_scheduler *sched, powertask_energy_source_t *energy_source);
+int powertask_run_scheduler(powertask_scheduler *sched, powertask_energy_source_t *energy_source);
+
+/**
+ * @brief Runs the scheduled tasks from an energy pool
+ * 
+ * @details Same as powertask_run_scheduler(), but each task is admitted against
+ * the source picked by the pool policy, which is selected before the task action
+ * is executed. The sources are read for every task.
+ * 
+ * @param[in] sched Scheduler instance
+ * @param[in] pool  Energy pool used to run scheduled tasks
+ * 
+ * @retval Number of tasks executed during this run.
+ * @retval -EINVAL \p sched or \p pool is NULL.
+ */
+int powertask_run_scheduler_pool(powertask_scheduler *sched, powertask_energy_pool_t *pool);
+
+/**
+ * @brief Invalidates the task states kept in RAM
+ * 
+ * @details The scheduler only loads the stored state when its RAM state was
+ * lost (e.g. after a reset or power loss). Call this function when the task
+ * states in RAM can no longer be trusted, e.g. when the scheduler is placed in
+ * a memory section that is not initialized on boot.
+ * 
+ * @param[in] sched Scheduler instance
+ */
+void powertask_invalidate_state(powertask_scheduler *sched);
 
 /**
  * @brief Add task to a scheduler
  * 
  * @param[in] sched Scheduler to which the task will be added.
  * @param[in] task  Task to be added to the scheduler.
+ * 
+ * @return 0, if successful
+ * @return -ENOSPC the scheduler already holds its maximum number of tasks.
+ * @return -EEXIST a task with the same non-zero id (see powertask_task_id())
+ * is already in the scheduler.
+ * @return -EINVAL \p sched or \p task is NULL.
 */
-void powertask_add(powertask_scheduler *sched, powertask_task *task);
+int powertask_add(powertask_scheduler *sched, powertask_task *task);
+
+/**
+ * @brief Submit a task activation
+ * 
+ * @details Safe to call from interrupt handlers and other threads while the
+ * scheduler is running. The activation is applied at the start of the next
+ * run: a task that is not in the scheduler is added to it and a complete task
+ * becomes pending again. If the scheduler is full, the activation is dropped
+ * and counted (see powertask_get_dropped_submissions()). Activations of tasks
+ * that cannot be added for another reason (see powertask_add()) are dropped
+ * without being counted, and leave the task unchanged.
+ * 
+ * @param[in] sched Scheduler instance
+ * @param[in] task  Task to be activated.
+ * 
+ * @return 0, if successful
+ * @return -ENOSPC the submission queue is full.
+ * @return -EINVAL \p sched or \p task is NULL, or \p sched has no submission
+ * queue.
+ */
+int powertask_submit(powertask_scheduler *sched, powertask_task *task);
+
+/**
+ * @brief Get the number of dropped task activations
+ * 
+ * @details Submitted tasks that were not in the scheduler and could not be
+ * added to it because it was full.
+ * 
+ * @param[in] sched Scheduler instance
+ * 
+ * @retval Number of activations dropped since the scheduler was created.
+ * @retval -EINVAL \p sched is NULL.
+ */
+int powertask_get_dropped_submissions(powertask_scheduler *sched);
+
+/**
+ * @brief Get the number of pending tasks
+ * 
+ * @details Constant time. The count is maintained as tasks are added and
+ * executed.
+ * 
+ * @param[in] sched Scheduler instance
+ * 
+ * @retval Number of tasks not yet executed in the current round.
+ * @retval -EINVAL \p sched is NULL.
+ */
+int powertask_get_pending_tasks(powertask_scheduler *sched);
+
+/**
+ * @brief Get the pending task requiring the least energy
+ * 
+ * @details Amortized constant time. Tasks are indexed by required energy when
+ * added, and the search resumes from the last cheapest pending task. Schedulers
+ * not created with POWERTASK_INIT() have no index, and their tasks are searched
+ * in linear time instead.
+ * 
+ * @param[in] sched Scheduler instance
+ * 
+ * @return Cheapest pending task, or NULL if there is none.
+ */
+powertask_task *powertask_get_cheapest_pending_task(powertask_scheduler *sched);
+
+/**
+ * @brief Get the energy required by the cheapest pending task
+ * 
+ * @details Includes the setup energy of the resource used by the task. While
+ * a task holds an energy reservation, the other tasks also need the reserved
+ * energy, so the result is the lowest of the energy of the holder and of the
+ * cheapest other task plus the reserved energy. The reservation is the one
+ * made by the last run. If the available energy is not above the result,
+ * running the scheduler cannot make progress.
+ * 
+ * @param[in] sched Scheduler instance
+ * 
+ * @retval Energy (in uJ) required by the cheapest pending task.
+ * @retval -ENOENT There are no pending tasks.
+ * @retval -EINVAL \p sched is NULL.
+ */
+int powertask_get_cheapest_pending_energy(powertask_scheduler *sched);
+
+/**
+ * @brief Maximum number of tasks of a scheduler created with POWERTASK_INIT()
+ *
+ * @details In the minimal profile, the state of every task must fit in the
+ * stored state, or no checkpoint would ever be written.
+ */
+#ifdef POWERTASK_CONFIG_MINIMAL
+#define POWERTASK_INIT_MAX_TASKS POWERTASK_CONFIG_MAX_TASKS
+#else
+#define POWERTASK_INIT_MAX_TASKS POWERTASK_COUNT_MAX
+#endif
 
 /** 
  * @brief Initialize scheduler
  * 
  * @param[in] _name Name to be given to the scheduler.
- * @param[in] _number_of_tasks Maximum number of tasks to be allowed on the scheduler. 
+ * @param[in] _number_of_tasks Maximum number of tasks to be allowed on the scheduler. At most
+ * POWERTASK_INIT_MAX_TASKS.
  */
-#define POWERTASK_INIT(_name, _number_of_tasks)                         \
-    static powertask_task * _name##_list_of_tasks[_number_of_tasks];    \
-    static struct powertask_scheduler_s _name = {                       \
-        .list_of_tasks = _name##_list_of_tasks ,                        \
-        ._list_of_tasks_len = _number_of_tasks,                       \
+#define POWERTASK_INIT(_name, _number_of_tasks)                                                       \
+    static_assert((_number_of_tasks) <= POWERTASK_INIT_MAX_TASKS, "too many tasks for the profile");   \
+    static powertask_task * _name##_list_of_tasks[_number_of_tasks];                                  \
+    static powertask_count_t _name##_tasks_by_cost[_number_of_tasks];                                 \
+    static uint32_t _name##_state_buffer[POWERTASK_STATE_SIZE(_number_of_tasks) / sizeof(uint32_t)];  \
+    static struct powertask_scheduler_s _name = {                                                     \
+        .list_of_tasks = _name##_list_of_tasks ,                                                      \
+        ._list_of_tasks_len = _number_of_tasks,                                                       \
+        ._state_buffer = _name##_state_buffer,                                                        \
+        ._tasks_by_cost = _name##_tasks_by_cost,                                                      \
+}
+
+/**
+ * @brief Stable task identifier
+ * 
+ * @details FNV-1a hash of the task name. Task states are stored by identifier,
+ * so adding, removing or reordering tasks (e.g. in a firmware update) keeps the
+ * progress of the unchanged ones. Ids must be unique within a scheduler, and
+ * tasks with a duplicate id are not added. Id 0 means no id: tasks set up
+ * without the task macros keep it, and their state is restored by position. A
+ * renamed task can keep its id with POWERTASK_TASK_WITH_ID(). Optimizing
+ * compilers fold the hash of a string literal into a constant.
+ * 
+ * @param[in] name Task name.
+ * 
+ * @return Task identifier.
+ */
+static inline uint32_t powertask_task_id(const char *name)
+{
+    uint32_t hash = 2166136261U;
+
+    while(*name != '\0'){
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619U;
+    }
+
+    return hash;
 }
 
 /** @brief Implementation of run always macro. */
@@ -77,6 +349,33 @@ static bool _is_##_name##_complete() {      \
     return task_##_name.complete;           \
 }
 
+/**
+ * @brief Implementation of the task macros.
+ * 
+ * @details Sets the task id and the task description from the designated
+ * initializers in the variadic arguments, and adds the task to the scheduler.
+ * In the const task profile the description is placed in a static const table,
+ * so the description arguments of the task macros must then be constant
+ * expressions (function names, literals, enumerators or addresses of static
+ * objects), and each task may only be added once per scope.
+ */
+#if POWERTASK_CONFIG_CONST_TASKS
+#define POWERTASK_ADD_TASK(_scheduler, _name, _id, ...)                             \
+static const powertask_task_info task_##_name##_info = { __VA_ARGS__ };             \
+task_##_name = (powertask_task){                                                    \
+    .info = &task_##_name##_info,                                                   \
+    .id = _id,                                                                      \
+};                                                                                  \
+powertask_add(&_scheduler, &task_##_name);
+#else
+#define POWERTASK_ADD_TASK(_scheduler, _name, _id, ...)                             \
+task_##_name = (powertask_task){                                                    \
+    __VA_ARGS__,                                                                    \
+    .id = _id,                                                                      \
+};                                                                                  \
+powertask_add(&_scheduler, &task_##_name);
+#endif
+
 /**
  * @brief Declare task
  * 
@@ -85,15 +384,125 @@ static bool _is_##_name##_complete() {      \
  * @param[in] _action           Action to be executed.
  * @param[in] _condition        Function defining in which condition the action
  * will be executed.
- * @param[in] _required_energy  Minimum amount of energy (in Joules) required to
+ * @param[in] _required_energy  Minimum amount of energy (in uJ) required to
  * execute the action.
+ * 
+ * @note In the const task profile, \p _action, \p _condition and
+ * \p _required_energy must be constant expressions (see POWERTASK_ADD_TASK()).
  */
 #define POWERTASK_TASK(_scheduler, _name, _action, _condition, _required_energy)    \
-task_##_name = (powertask_task){                                                    \
+POWERTASK_ADD_TASK(_scheduler, _name, powertask_task_id(#_name),                    \
     .action = _action,                                                              \
     .condition = _condition,                                                        \
-    .required_energy = _required_energy,                                            \
-};                                                                                  \
-powertask_add(&_scheduler, &task_##_name);
+    .required_energy = _required_energy)
+
+/**
+ * @brief Declare task with an explicit id
+ * 
+ * @details Same as POWERTASK_TASK(), but the stored state of the task is
+ * matched by \p _id instead of the hash of its name, so it survives renaming
+ * the task, e.g. with powertask_task_id("old_name").
+ * 
+ * @param[in] _scheduler        Scheduler to which task should be added.
+ * @param[in] _name             Name used to identify the task.
+ * @param[in] _id               Id of the task, unique within the scheduler.
+ * @param[in] _action           Action to be executed.
+ * @param[in] _condition        Function defining in which condition the action
+ * will be executed.
+ * @param[in] _required_energy  Minimum amount of energy (in uJ) required to
+ * execute the action.
+ * 
+ * @note In the const task profile, \p _action, \p _condition and
+ * \p _required_energy must be constant expressions. \p _id may be computed.
+ */
+#define POWERTASK_TASK_WITH_ID(_scheduler, _name, _id, _action, _condition, _required_energy)  \
+POWERTASK_ADD_TASK(_scheduler, _name, _id,                                                    \
+    .action = _action,                                                                        \
+    .condition = _condition,                                                                  \
+    .required_energy = _required_energy)
+
+/**
+ * @brief Declare resource
+ * 
+ * @param[in] _name         Name used to identify the resource.
+ * @param[in] _setup        Function powering the resource up.
+ * @param[in] _teardown     Function powering the resource down.
+ * @param[in] _setup_energy Energy (in uJ) spent powering the resource up
+ * and down.
+ */
+#define POWERTASK_RESOURCE(_name, _setup, _teardown, _setup_energy)    \
+static powertask_resource resource_##_name = {                          \
+    .setup = _setup,                                                    \
+    .teardown = _teardown,                                              \
+    .setup_energy = _setup_energy,                                      \
+}
+
+/**
+ * @brief Declare task using a resource
+ * 
+ * @param[in] _scheduler        Scheduler to which task should be added.
+ * @param[in] _name             Name used to identify the task.
+ * @param[in] _action           Action to be executed.
+ * @param[in] _condition        Function defining in which condition the action
+ * will be executed.
+ * @param[in] _required_energy  Minimum amount of energy (in uJ) required to
+ * execute the action, excluding the resource setup energy.
+ * @param[in] _resource         Name of the resource used by the action.
+ * 
+ * @note In the const task profile, \p _action, \p _condition and
+ * \p _required_energy must be constant expressions. The resource is static, so
+ * its address is one.
+ */
+#define POWERTASK_TASK_WITH_RESOURCE(_scheduler, _name, _action, _condition, _required_energy, _resource)  \
+POWERTASK_ADD_TASK(_scheduler, _name, powertask_task_id(#_name),                                           \
+    .action = _action,                                                                                    \
+    .condition = _condition,                                                                              \
+    .required_energy = _required_energy,                                                                  \
+    .resource = &resource_##_resource)
+
+/**
+ * @brief Declare task drawing from a pool source
+ * 
+ * @param[in] _scheduler        Scheduler to which task should be added.
+ * @param[in] _name             Name used to identify the task.
+ * @param[in] _action           Action to be executed.
+ * @param[in] _condition        Function defining in which condition the action
+ * will be executed.
+ * @param[in] _required_energy  Minimum amount of energy (in uJ) required to
+ * execute the action.
+ * @param[in] _source           Index of the pool source preferred by the task.
+ * 
+ * @note In the const task profile, \p _action, \p _condition,
+ * \p _required_energy and \p _source must be constant expressions.
+ */
+#define POWERTASK_TASK_WITH_SOURCE(_scheduler, _name, _action, _condition, _required_energy, _source)  \
+POWERTASK_ADD_TASK(_scheduler, _name, powertask_task_id(#_name),                                       \
+    .action = _action,                                                                                \
+    .condition = _condition,                                                                          \
+    .required_energy = _required_energy,                                                              \
+    .source = _source)
+
+/**
+ * @brief Declare task reserving energy
+ * 
+ * @param[in] _scheduler        Scheduler to which task should be added.
+ * @param[in] _name             Name used to identify the task.
+ * @param[in] _action           Action to be executed.
+ * @param[in] _condition        Function defining in which condition the action
+ * will be executed.
+ * @param[in] _required_energy  Minimum amount of energy (in uJ) required to
+ * execute the action.
+ * @param[in] _reserved_energy  Energy (in uJ) other tasks may not use while
+ * the task is pending.
+ * 
+ * @note In the const task profile, \p _action, \p _condition,
+ * \p _required_energy and \p _reserved_energy must be constant expressions.
+ */
+#define POWERTASK_TASK_WITH_RESERVATION(_scheduler, _name, _action, _condition, _required_energy, _reserved_energy)  \
+POWERTASK_ADD_TASK(_scheduler, _name, powertask_task_id(#_name),                                                     \
+    .action = _action,                                                                                              \
+    .condition = _condition,                                                                                        \
+    .required_energy = _required_energy,                                                                            \
+    .reserved_energy = _reserved_energy)
 
 #endif /* POWERTASK_SCHEDULER_H */
@@ -1,6 +1,8 @@
 #ifndef POWERTASK_STORAGE_H
 #define POWERTASK_STORAGE_H
 
+#include <stddef.h>
+
 /**
  * @brief Save in storage
  * 
@@ -19,8 +21,39 @@ int powertask_storage_save(void *data_to_store, size_t size_of_data);
  * @param[in] size_of_data  Size of the buffer
  * 
  * @return 0, if successful
+ * @return -ENOSPC the stored data does not fit in the buffer. The scheduler
+ * then retries with a larger buffer.
  * @return negative value, otherwise
 */
 int powertask_storage_load(void *buffer, size_t size_of_buffer);
 
+/**
+ * @brief Write in the trace region of the storage
+ * 
+ * @details Only required when the scheduler trace is used. The trace region is
+ * separate from the one used by powertask_storage_save().
+ * 
+ * @param[in] offset        Offset, within the trace region, to write at.
+ * @param[in] data_to_store Data to be stored
+ * @param[in] size_of_data  Size of data to be stored
+ * 
+ * @return 0, if successful
+ * @return negative value, otherwise
+*/
+int powertask_storage_trace_write(size_t offset, const void *data_to_store, size_t size_of_data);
+
+/**
+ * @brief Read from the trace region of the storage
+ * 
+ * @details Only required when the scheduler trace is used.
+ * 
+ * @param[in]  offset         Offset, within the trace region, to read from.
+ * @param[out] buffer         Buffer in which loaded data will be copied to
+ * @param[in]  size_of_buffer Size of the buffer
+ * 
+ * @return 0, if successful
+ * @return negative value, otherwise
+*/
+int powertask_storage_trace_read(size_t offset, void *buffer, size_t size_of_buffer);
+
 #endif /* POWERTASK_STORAGE_H */
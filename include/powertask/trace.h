@@ -0,0 +1,162 @@
+#ifndef POWERTASK_TRACE_H
+#define POWERTASK_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Value identifying an initialized trace region, and its layout, in storage. */
+#define POWERTASK_TRACE_MAGIC 0x50545433U
+
+/** @brief Task id used by records that are not related to a task. */
+#define POWERTASK_TRACE_NO_TASK 0xFFFFFFFFU
+
+/**
+ * @brief Id recorded for a task
+ * 
+ * @details Task ids are recorded on 31 bits, as in the stored scheduler state,
+ * so they never match POWERTASK_TRACE_NO_TASK.
+ * 
+ * @param[in] _id Task id (see powertask_task_id()).
+ */
+#define POWERTASK_TRACE_TASK_ID(_id) ((uint32_t)(_id) & 0x7FFFFFFFU)
+
+/** @brief Scheduler events */
+typedef enum powertask_trace_event_e {
+    POWERTASK_TRACE_RESET = 1,          /**< Scheduler state was lost (reset or power failure). */
+    POWERTASK_TRACE_ADMITTED,           /**< Task had enough energy and its condition was met. */
+    POWERTASK_TRACE_SKIPPED_ENERGY,     /**< Task was skipped due to lack of energy. */
+    POWERTASK_TRACE_SKIPPED_CONDITION,  /**< Task was skipped because its condition was not met. */
+    POWERTASK_TRACE_COMPLETED,          /**< Task action was executed. */
+    POWERTASK_TRACE_CHECKPOINT,         /**< Scheduler state was saved. */
+    POWERTASK_TRACE_REPEATED,           /**< Pass repeated the events of the pass before it, count times. */
+} powertask_trace_event_t;
+
+/** @brief Trace record, as written to storage */
+typedef struct powertask_trace_record_s {
+    uint8_t event;    /**< Event (powertask_trace_event_t). */
+    uint8_t _unused;  /**< Padding, written as 0. */
+    uint16_t count;   /**< Number of occurrences coalesced into this record. */
+    uint32_t task;    /**< Stable id of the task (see powertask_task_id()), or POWERTASK_TRACE_NO_TASK. */
+} powertask_trace_record_t;
+
+/** @brief Header of the trace region in storage. Followed by the ring of records. */
+typedef struct powertask_trace_header_s {
+    uint32_t magic;    /**< POWERTASK_TRACE_MAGIC if the region is initialized. */
+    uint16_t capacity; /**< Number of records in the ring. */
+    uint16_t head;     /**< Index of the slot where the next record is written. */
+    uint16_t used;     /**< Number of valid records in the ring. */
+    uint16_t _unused;  /**< Padding, written as 0. */
+} powertask_trace_header_t;
+
+/** @brief Persistent trace */
+typedef struct powertask_trace_s {
+    powertask_trace_record_t *batch; /**< Records waiting to be written to storage. */
+    uint16_t batch_len;              /**< Maximum number of records in a batch. */
+    uint16_t capacity;               /**< Number of records in the persistent ring. */
+    uint16_t flush_interval;         /**< Checkpoints between writes of batches holding only skipped events. */
+    uint16_t _batched;               /**< Number of records in the batch. */
+    uint16_t _checkpoints;           /**< Checkpoints since the last write. */
+    uint16_t _pass_start;            /**< Index, in the batch, of the first record of the current pass. */
+    uint16_t _pass_events;           /**< Events recorded in the current pass. */
+    uint16_t _previous_events;       /**< Events recorded in the previous pass. */
+    uint32_t _pass_hash;             /**< Hash of the events of the current pass. */
+    uint32_t _previous_hash;         /**< Hash of the events of the previous pass. */
+    bool _pass_split;                /**< Records of the current pass were written before its checkpoint. */
+    bool _pass_urgent;               /**< The current pass recorded events other than skips. */
+    bool _urgent;                    /**< The batch holds records to be written on the next checkpoint. */
+    bool _loaded;                    /**< Header was read from storage. */
+    powertask_trace_header_t _header; /**< Header of the trace region. */
+} powertask_trace_t;
+
+/**
+ * @brief Initialize trace
+ * 
+ * @param[in] _name           Name to be given to the trace.
+ * @param[in] _batch_len      Number of records kept in RAM before writing them.
+ * @param[in] _capacity       Number of records in the persistent ring.
+ * @param[in] _flush_interval Checkpoints between writes of batches holding
+ * only skipped events.
+ */
+#define POWERTASK_TRACE_INIT(_name, _batch_len, _capacity, _flush_interval) \
+    static powertask_trace_record_t _name##_batch[_batch_len];              \
+    static powertask_trace_t _name = {                                      \
+        .batch = _name##_batch,                                             \
+        .batch_len = _batch_len,                                            \
+        .capacity = _capacity,                                              \
+        .flush_interval = _flush_interval,                                  \
+}
+
+/**
+ * @brief Size of the trace region in storage
+ * 
+ * @param[in] _capacity Number of records in the persistent ring.
+ */
+#define POWERTASK_TRACE_REGION_SIZE(_capacity) \
+    (sizeof(powertask_trace_header_t) + (_capacity) * sizeof(powertask_trace_record_t))
+
+/**
+ * @brief Record an event
+ * 
+ * @details Records are kept in RAM. An event repeating the previous record
+ * of the same pass (same event and task) increments that record count instead
+ * of using a new record.
+ * A checkpoint ends a pass. A pass holding only skips and the same events as
+ * the pass before it is replaced by a POWERTASK_TRACE_REPEATED record, so that
+ * a scheduler waiting for energy does not fill the ring.
+ * Admissions are written right away, so that a power failure during the action
+ * still shows the running task. Other batches are written on checkpoints when
+ * they contain events other than skips and at least every flush_interval
+ * checkpoints otherwise. Full batches are written right away.
+ * 
+ * @param[in] trace Trace instance
+ * @param[in] event Event to be recorded
+ * @param[in] task  Stable id of the task, or POWERTASK_TRACE_NO_TASK.
+ * 
+ * @return 0, if successful
+ * @return -EINVAL \p trace is NULL
+ * @return negative value, if writing a full batch to storage failed.
+ */
+int powertask_trace_record(powertask_trace_t *trace, powertask_trace_event_t event, uint32_t task);
+
+/**
+ * @brief Write the batched records to storage
+ * 
+ * @param[in] trace Trace instance
+ * 
+ * @return 0, if successful
+ * @return negative value, otherwise
+ */
+int powertask_trace_flush(powertask_trace_t *trace);
+
+/**
+ * @brief Decode a trace region
+ * 
+ * @details Calls \p callback for every record in the region, from the oldest to
+ * the newest. Decoding stops if \p callback returns a non-zero value.
+ * 
+ * The capacity of the ring is read from the header, so the copy may extend
+ * past the region, e.g. when a whole flash page or partition is dumped.
+ * 
+ * @param[in] region   Copy of the trace region.
+ * @param[in] size     Size of the copy. At least the size of the region.
+ * @param[in] callback Function called for each record.
+ * @param[in] ctx      Context passed to \p callback.
+ * 
+ * @return Number of decoded records, if successful
+ * @return -EINVAL the region is not a valid trace, is larger than \p size or
+ * parameters are NULL.
+ */
+int powertask_trace_decode(const void *region, size_t size,
+                           int (*callback)(const powertask_trace_record_t *record, void *ctx), void *ctx);
+
+/**
+ * @brief Get the name of an event
+ * 
+ * @param[in] event Event
+ * 
+ * @return Printable name of the event.
+ */
+const char *powertask_trace_event_name(int event);
+
+#endif /* POWERTASK_TRACE_H */
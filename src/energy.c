@@ -7,10 +7,149 @@
 /*                                                    Private API                                                     */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
+static int read_samples(powertask_energy_source_t *energy_source, int *buffer, size_t number_of_samples){
+    powertask_sampler_t *sampler = energy_source->sampler;
+
+    if(sampler->read_samples != NULL){
+        return sampler->read_samples(buffer, number_of_samples) < 0 ? -EIO : 0;
+    }
+
+    for(size_t i = 0; i < number_of_samples; i++){
+        buffer[i] = energy_source->get_voltage();
+    }
+
+    return 0;
+}
+
+static int median(int *samples, size_t number_of_samples){
+    /* Insertion sort: batches are small and the buffer is scratch space. */
+    for(size_t i = 1; i < number_of_samples; i++){
+        int sample = samples[i];
+        size_t j = i;
+
+        for(; j > 0 && samples[j - 1] > sample; j--){
+            samples[j] = samples[j - 1];
+        }
+        samples[j] = sample;
+    }
+
+    return samples[number_of_samples / 2];
+}
+
+static bool is_valid_sampler(powertask_sampler_t *sampler){
+    if(sampler->filter == POWERTASK_FILTER_MEDIAN && (sampler->buffer == NULL || sampler->buffer_len == 0)){
+        return false;
+    }
+
+    return sampler->filter != POWERTASK_FILTER_EWMA ||
+           (sampler->ewma_shift >= 0 && sampler->ewma_shift <= POWERTASK_SAMPLER_MAX_EWMA_SHIFT);
+}
+
+static int sample_voltage(powertask_energy_source_t *energy_source){
+    powertask_sampler_t *sampler = energy_source->sampler;
+    int sample;
+
+    if(!is_valid_sampler(sampler)){
+        return -EINVAL;
+    }
+
+    switch(sampler->filter){
+    case POWERTASK_FILTER_MEDIAN:
+        if(read_samples(energy_source, sampler->buffer, sampler->buffer_len) < 0){
+            return -EIO;
+        }
+        sampler->_filtered = median(sampler->buffer, sampler->buffer_len);
+        break;
+
+    case POWERTASK_FILTER_EWMA:
+        if(read_samples(energy_source, &sample, 1) < 0){
+            return -EIO;
+        }
+        /* Fixed point: dividing the update instead would truncate and settle up to 2^ewma_shift - 1 mV away. */
+        if(!sampler->_primed){
+            /* Not a shift: shifting a negative sample (e.g. an ADC offset) is undefined. */
+            sampler->_ewma = sample * (1 << sampler->ewma_shift);
+        } else {
+            sampler->_ewma += sample - (sampler->_ewma >> sampler->ewma_shift);
+        }
+        sampler->_filtered = sampler->_ewma >> sampler->ewma_shift;
+        break;
+
+    case POWERTASK_FILTER_NONE:
+    default:
+        if(read_samples(energy_source, &sample, 1) < 0){
+            return -EIO;
+        }
+        sampler->_filtered = sample;
+        break;
+    }
+
+    if(!sampler->_primed || sampler->_filtered > sampler->_reported + sampler->hysteresis ||
+       sampler->_filtered < sampler->_reported - sampler->hysteresis){
+        sampler->_reported = sampler->_filtered;
+        sampler->_primed = true;
+    }
+
+    return sampler->_reported;
+}
+
+static long long isqrt(long long value){
+    long long root = 0;
+    long long bit = 1LL << 62;
+
+    while(bit > value){
+        bit >>= 2;
+    }
+
+    while(bit != 0){
+        if(value >= root + bit){
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
 /* ------------------------------------------------------------------------------------------------------------------ */
 /*                                                     Public API                                                     */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
+int powertask_sampler_init(powertask_sampler_t *sampler){
+    if(sampler == NULL || !is_valid_sampler(sampler)){
+        return -EINVAL;
+    }
+
+    sampler->_ewma = 0;
+    sampler->_filtered = 0;
+    sampler->_reported = 0;
+    sampler->_primed = false;
+
+    return 0;
+}
+
+int powertask_get_voltage(powertask_energy_source_t *energy_source){
+    if(energy_source == NULL){
+        return -EINVAL;
+    }
+
+    if(energy_source->sampler == NULL){
+        if(energy_source->get_voltage == NULL){
+            return -EINVAL;
+        }
+        return energy_source->get_voltage();
+    }
+
+    if(energy_source->sampler->read_samples == NULL && energy_source->get_voltage == NULL){
+        return -EINVAL;
+    }
+
+    return sample_voltage(energy_source);
+}
+
 int powertask_get_available_energy(powertask_energy_source_t *energy_source){
     int voltage_mV, capacitance_uF;
 
@@ -18,12 +157,34 @@ int powertask_get_available_energy(powertask_energy_source_t *energy_source){
         return -EINVAL;
     }
 
-    if(energy_source->capacitance == 0 || energy_source->get_voltage == NULL){
+    if(energy_source->capacitance == 0){
         return -EINVAL;
     }
 
-    voltage_mV = energy_source->get_voltage();
+    voltage_mV = powertask_get_voltage(energy_source);
+
+    if(voltage_mV < 0){
+        return voltage_mV;
+    }
+
     capacitance_uF = energy_source->capacitance;
 
-    return capacitance_uF * voltage_mV * voltage_mV * (1/2000000);
+    return (int)((long long)capacitance_uF * voltage_mV * voltage_mV / 2000000);
+}
+
+int powertask_get_voltage_for_energy(powertask_energy_source_t *energy_source, int energy){
+    long long voltage_mV;
+
+    if(energy_source == NULL || energy_source->capacitance <= 0 || energy < 0){
+        return -EINVAL;
+    }
+
+    voltage_mV = isqrt(((long long)energy + 1) * 2000000 / energy_source->capacitance);
+
+    /* Round up until the energy at that voltage exceeds the requested amount. */
+    while((long long)energy_source->capacitance * voltage_mV * voltage_mV / 2000000 <= energy){
+        voltage_mV++;
+    }
+
+    return (int)voltage_mV;
 }
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+
+#include <powertask/fleet.h>
+#include <powertask/energy.h>
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+static bool is_valid_fleet(powertask_fleet_t *fleet){
+    return fleet != NULL && fleet->tasks != NULL && fleet->number_of_nodes >= 0 &&
+           fleet->number_of_tasks >= 0 && fleet->number_of_tasks <= POWERTASK_FLEET_MAX_TASKS &&
+           fleet->learning_shift >= 0 && fleet->learning_shift <= POWERTASK_FLEET_MAX_LEARNING_SHIFT &&
+           fleet->energy != NULL && fleet->complete != NULL && fleet->cost != NULL &&
+           fleet->learned_cost != NULL && fleet->rounds != NULL && fleet->brownouts != NULL &&
+           fleet->_stored != NULL;
+}
+
+/** @brief Harvests energy and keeps the stored state, which a brownout restores. */
+static void harvest_energy(powertask_fleet_t *fleet, const int32_t *harvest){
+    const int nodes = fleet->number_of_nodes;
+    const int32_t max_energy = fleet->max_energy > 0 ? fleet->max_energy : INT32_MAX;
+    int32_t *restrict energy = fleet->energy;
+    const uint32_t *restrict complete = fleet->complete;
+    uint32_t *restrict stored = fleet->_stored;
+
+    for(int node = 0; node < nodes; node++){
+        stored[node] = complete[node];
+    }
+
+    if(harvest == NULL){
+        return;
+    }
+
+    for(int node = 0; node < nodes; node++){
+        int32_t room = max_energy - energy[node];
+
+        energy[node] += harvest[node] > room ? room : harvest[node];
+    }
+}
+
+/**
+ * @brief Runs one task on every node
+ *
+ * @details Branch-free over the nodes, so that the compiler can vectorize it.
+ * A browned out node is left with negative energy, so no other task is
+ * admitted in the step. The arrays are parameters so that restrict applies.
+ */
+static int run_task(const powertask_fleet_t *fleet, int task,
+                    int32_t *restrict energy, uint32_t *restrict complete, const uint32_t *restrict stored,
+                    uint32_t *restrict brownouts, const int32_t *restrict cost, int32_t *restrict learned_cost){
+    const int nodes = fleet->number_of_nodes;
+    const uint32_t bit = 1U << task;
+    const uint32_t wait_for = fleet->tasks[task].wait_for;
+    const int32_t declared_energy = fleet->tasks[task].required_energy;
+    const int learning = fleet->learning_shift > 0;
+    const int learning_shift = learning ? fleet->learning_shift : 0;
+    int executed_tasks = 0;
+
+    for(int node = 0; node < nodes; node++){
+        /* Every operand is loaded up front so that the selects below need no branches. */
+        int32_t available_energy = energy[node];
+        uint32_t complete_tasks = complete[node];
+        uint32_t stored_tasks = stored[node];
+        int32_t spent_energy = cost[node];
+        int32_t learned_energy = learned_cost[node];
+        int32_t required_energy = learning ? learned_energy : declared_energy;
+        int run = ((complete_tasks & bit) == 0) &
+                  ((complete_tasks & wait_for) == wait_for) &
+                  powertask_admit(available_energy, required_energy);
+        int32_t left = available_energy - spent_energy;
+        int browned_out = run & (left < 0);
+        int done = run & !browned_out;
+        int32_t next_energy = run ? left : available_energy;
+
+        energy[node] = next_energy < 0 ? -1 : next_energy;
+        complete[node] = browned_out ? stored_tasks : (complete_tasks | (done ? bit : 0));
+        brownouts[node] += browned_out;
+
+        /* Arithmetic shift: the learned cost converges from both sides. */
+        learned_cost[node] = learned_energy + ((done & learning) ? (spent_energy - learned_energy) >> learning_shift : 0);
+
+        executed_tasks += done;
+    }
+
+    return executed_tasks;
+}
+
+/** @brief Starts a new round on the nodes that completed every task. */
+static void finish_step(powertask_fleet_t *fleet){
+    const int nodes = fleet->number_of_nodes;
+    const uint32_t all_tasks = fleet->number_of_tasks == 32 ? UINT32_MAX : (1U << fleet->number_of_tasks) - 1;
+    int32_t *restrict energy = fleet->energy;
+    uint32_t *restrict complete = fleet->complete;
+    uint32_t *restrict rounds = fleet->rounds;
+    int finished;
+
+    for(int node = 0; node < nodes; node++){
+        finished = complete[node] == all_tasks;
+
+        rounds[node] += finished;
+        complete[node] = finished ? 0 : complete[node];
+        energy[node] = energy[node] < 0 ? 0 : energy[node];
+    }
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_fleet_init(powertask_fleet_t *fleet){
+    if(!is_valid_fleet(fleet)){
+        return -EINVAL;
+    }
+
+    for(int node = 0; node < fleet->number_of_nodes; node++){
+        fleet->energy[node] = 0;
+        fleet->complete[node] = 0;
+        fleet->_stored[node] = 0;
+        fleet->rounds[node] = 0;
+        fleet->brownouts[node] = 0;
+    }
+
+    for(int task = 0; task < fleet->number_of_tasks; task++){
+        for(int node = 0; node < fleet->number_of_nodes; node++){
+            fleet->cost[POWERTASK_FLEET_INDEX(fleet, task, node)] = fleet->tasks[task].cost;
+            fleet->learned_cost[POWERTASK_FLEET_INDEX(fleet, task, node)] = fleet->tasks[task].required_energy;
+        }
+    }
+
+    return 0;
+}
+
+int powertask_fleet_step(powertask_fleet_t *fleet, const int32_t *harvest){
+    int executed_tasks = 0;
+
+    if(!is_valid_fleet(fleet)){
+        return -EINVAL;
+    }
+
+    harvest_energy(fleet, harvest);
+
+    /* Task by task rather than node by node: each pass streams through contiguous arrays. */
+    for(int task = 0; task < fleet->number_of_tasks; task++){
+        executed_tasks += run_task(fleet, task, fleet->energy, fleet->complete, fleet->_stored, fleet->brownouts,
+                                   &fleet->cost[POWERTASK_FLEET_INDEX(fleet, task, 0)],
+                                   &fleet->learned_cost[POWERTASK_FLEET_INDEX(fleet, task, 0)]);
+    }
+
+    finish_step(fleet);
+
+    return executed_tasks;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <errno.h>
+
+#include <powertask/platform.h>
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Sleeps until the cheapest pending task can be afforded
+ * 
+ * @return false if there is already enough energy for it (or nothing is pending).
+ */
+static bool wait_for_energy(powertask_scheduler *sched, powertask_energy_source_t *energy_source,
+                            powertask_platform_t *platform){
+    int cheapest = powertask_get_cheapest_pending_energy(sched);
+    int threshold;
+
+    if(cheapest < 0 || powertask_get_available_energy(energy_source) > cheapest){
+        return false;
+    }
+
+    threshold = powertask_get_voltage_for_energy(energy_source, cheapest);
+
+    if(platform->set_voltage_wakeup == NULL || threshold < 0 || platform->set_voltage_wakeup(threshold) != 0){
+        platform->set_timer_wakeup(platform->idle_timeout);
+    }
+
+    platform->sleep();
+    return true;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_run_forever(powertask_scheduler *sched, powertask_energy_source_t *energy_source,
+                          powertask_platform_t *platform){
+    bool first_pass = true;
+
+    if(sched == NULL || energy_source == NULL || platform == NULL){
+        return -EINVAL;
+    }
+
+    if(platform->sleep == NULL || platform->set_timer_wakeup == NULL){
+        return -EINVAL;
+    }
+
+    while(platform->keep_running == NULL || platform->keep_running()){
+        /* A pass cannot make progress without energy for the cheapest pending task. Tasks are only known to be
+         * pending once the first pass has loaded the stored state, so that pass is not waited for. */
+        if(!first_pass && wait_for_energy(sched, energy_source, platform)){
+            continue;
+        }
+
+        first_pass = false;
+
+        if(powertask_run_scheduler(sched, energy_source) > 0){
+            continue;
+        }
+
+        /* Pending tasks are waiting on their conditions. */
+        if(!wait_for_energy(sched, energy_source, platform)){
+            platform->set_timer_wakeup(platform->idle_timeout);
+            platform->sleep();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <errno.h>
+
+#include <powertask/pool.h>
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+static bool is_valid_pool(powertask_energy_pool_t *pool){
+    return pool != NULL && pool->sources != NULL && pool->number_of_sources > 0;
+}
+
+static bool has_enough_energy(powertask_energy_pool_t *pool, int source, int required_energy){
+    return powertask_admit(powertask_pool_get_usable_energy(pool, source), required_energy);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_pool_get_usable_energy(powertask_energy_pool_t *pool, int source){
+    powertask_pool_source_t *pool_source;
+    int available_energy;
+
+    if(!is_valid_pool(pool) || source < 0 || source >= pool->number_of_sources){
+        return -EINVAL;
+    }
+
+    pool_source = &pool->sources[source];
+    available_energy = powertask_get_available_energy(pool_source->energy_source);
+
+    if(available_energy < 0){
+        return available_energy;
+    }
+
+    if(available_energy <= pool_source->reserve_energy){
+        return 0;
+    }
+
+    available_energy -= pool_source->reserve_energy;
+
+    if(pool_source->efficiency > 0){
+        available_energy = (int)((long long)available_energy * pool_source->efficiency / 100);
+    }
+
+    return available_energy;
+}
+
+int powertask_pool_get_available_energy(powertask_energy_pool_t *pool){
+    int available_energy = 0;
+    int usable_energy;
+
+    if(!is_valid_pool(pool)){
+        return -EINVAL;
+    }
+
+    for(int i = 0; i < pool->number_of_sources; i++){
+        usable_energy = powertask_pool_get_usable_energy(pool, i);
+
+        if(usable_energy > 0){
+            available_energy += usable_energy;
+        }
+    }
+
+    return available_energy;
+}
+
+int powertask_pool_select(powertask_energy_pool_t *pool, int preferred, int required_energy){
+
+    if(!is_valid_pool(pool)){
+        return -EINVAL;
+    }
+
+    if(preferred < 0 || preferred >= pool->number_of_sources){
+        preferred = 0;
+    }
+
+    switch(pool->policy){
+    case POWERTASK_POOL_COMBINED:
+        return powertask_admit(powertask_pool_get_available_energy(pool), required_energy) ? preferred : -ENOENT;
+
+    case POWERTASK_POOL_STRICT:
+        return has_enough_energy(pool, preferred, required_energy) ? preferred : -ENOENT;
+
+    case POWERTASK_POOL_PREFERRED:
+    default:
+        if(has_enough_energy(pool, preferred, required_energy)){
+            return preferred;
+        }
+
+        for(int i = 0; i < pool->number_of_sources; i++){
+            if(i != preferred && has_enough_energy(pool, i, required_energy)){
+                return i;
+            }
+        }
+
+        return -ENOENT;
+    }
+}
@@ -0,0 +1,138 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <powertask/port/linux.h>
+
+/** @brief Threshold value when no voltage wakeup is armed. */
+#define NO_THRESHOLD (-1)
+
+static int timer_fd = -1;
+static int event_fd = -1;
+static atomic_int voltage_threshold = NO_THRESHOLD;
+static atomic_int last_voltage;
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+static int signal_wakeup(void){
+    uint64_t value = 1;
+
+    return write(event_fd, &value, sizeof(value)) == sizeof(value) ? 0 : -errno;
+}
+
+static void linux_sleep(void){
+    const struct itimerspec disarmed = {0};
+    uint64_t value;
+    struct pollfd fds[] = {
+        { .fd = timer_fd, .events = POLLIN },
+        { .fd = event_fd, .events = POLLIN },
+    };
+
+    while(poll(fds, 2, -1) < 0 && errno == EINTR){
+    }
+
+    for(int i = 0; i < 2; i++){
+        if(fds[i].revents & POLLIN){
+            (void)!read(fds[i].fd, &value, sizeof(value));
+        }
+    }
+
+    /* A voltage wakeup leaves the timer armed, and it would end a later sleep. */
+    if(fds[1].revents & POLLIN){
+        (void)timerfd_settime(timer_fd, 0, &disarmed, NULL);
+    }
+
+    atomic_store(&voltage_threshold, NO_THRESHOLD);
+}
+
+static int linux_set_voltage_wakeup(int threshold){
+    atomic_store(&voltage_threshold, threshold);
+
+    /* The voltage may have crossed the threshold before it was armed. */
+    if(atomic_load(&last_voltage) >= threshold){
+        return signal_wakeup();
+    }
+
+    return 0;
+}
+
+static int linux_set_timer_wakeup(int timeout){
+    struct itimerspec spec = {
+        .it_value = {
+            .tv_sec = timeout / 1000,
+            .tv_nsec = (long)(timeout % 1000) * 1000000,
+        },
+    };
+
+    /* A zero it_value disarms the timer: wake up right away instead. */
+    if(timeout <= 0){
+        spec.it_value.tv_nsec = 1;
+    }
+
+    return timerfd_settime(timer_fd, 0, &spec, NULL) < 0 ? -errno : 0;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_linux_init(powertask_platform_t *platform){
+    if(platform == NULL){
+        return -EINVAL;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    event_fd = eventfd(0, EFD_CLOEXEC);
+
+    if(timer_fd < 0 || event_fd < 0){
+        powertask_linux_deinit();
+        return -EIO;
+    }
+
+    atomic_store(&voltage_threshold, NO_THRESHOLD);
+    atomic_store(&last_voltage, 0);
+
+    platform->sleep = linux_sleep;
+    platform->set_voltage_wakeup = linux_set_voltage_wakeup;
+    platform->set_timer_wakeup = linux_set_timer_wakeup;
+
+    return 0;
+}
+
+void powertask_linux_deinit(void){
+    if(timer_fd >= 0){
+        close(timer_fd);
+        timer_fd = -1;
+    }
+    if(event_fd >= 0){
+        close(event_fd);
+        event_fd = -1;
+    }
+}
+
+int powertask_linux_notify_voltage(int voltage){
+    int threshold;
+
+    if(event_fd < 0){
+        return -EINVAL;
+    }
+
+    atomic_store(&last_voltage, voltage);
+    threshold = atomic_load(&voltage_threshold);
+
+    if(threshold != NO_THRESHOLD && voltage >= threshold){
+        return signal_wakeup();
+    }
+
+    return 0;
+}
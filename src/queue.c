@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <powertask/queue.h>
+
+/*
+ * Bounded queue based on per-slot sequence numbers (D. Vyukov). A slot at index
+ * i is free for the push at position pos when its sequence is pos, and holds
+ * the task for the pop at position pos when its sequence is pos + 1. Sequences
+ * are stored minus the slot index so that a zero-initialized queue is valid.
+ */
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+static bool is_valid_queue(powertask_queue_t *queue){
+    return queue != NULL && queue->slots != NULL && queue->capacity != 0 &&
+           (queue->capacity & (queue->capacity - 1)) == 0;
+}
+
+static unsigned int load_sequence(powertask_queue_slot_t *slot, unsigned int index){
+    return __atomic_load_n(&slot->_sequence, __ATOMIC_ACQUIRE) + index;
+}
+
+static void store_sequence(powertask_queue_slot_t *slot, unsigned int index, unsigned int sequence){
+    __atomic_store_n(&slot->_sequence, sequence - index, __ATOMIC_RELEASE);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_queue_push(powertask_queue_t *queue, struct powertask_task_s *task){
+    powertask_queue_slot_t *slot;
+    unsigned int position, index;
+    int difference;
+
+    if(!is_valid_queue(queue) || task == NULL){
+        return -EINVAL;
+    }
+
+    position = __atomic_load_n(&queue->_head, __ATOMIC_RELAXED);
+
+    for(;;){
+        index = position & (queue->capacity - 1);
+        slot = &queue->slots[index];
+        difference = (int)(load_sequence(slot, index) - position);
+
+        if(difference == 0){
+            if(__atomic_compare_exchange_n(&queue->_head, &position, position + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                break;
+            }
+        } else if(difference < 0){
+            return -ENOSPC;
+        } else {
+            position = __atomic_load_n(&queue->_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->task = task;
+    store_sequence(slot, index, position + 1);
+
+    return 0;
+}
+
+struct powertask_task_s *powertask_queue_pop(powertask_queue_t *queue){
+    powertask_queue_slot_t *slot;
+    struct powertask_task_s *task;
+    unsigned int position, index;
+
+    if(!is_valid_queue(queue)){
+        return NULL;
+    }
+
+    position = queue->_tail;
+    index = position & (queue->capacity - 1);
+    slot = &queue->slots[index];
+
+    if((int)(load_sequence(slot, index) - (position + 1)) < 0){
+        return NULL;
+    }
+
+    task = slot->task;
+    store_sequence(slot, index, position + queue->capacity);
+    queue->_tail = position + 1;
+
+    return task;
+}
@@ -1,33 +1,135 @@
 #include <stdio.h>
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
 
 #include <powertask/scheduler.h>
 #include <powertask/energy.h>
+#include <powertask/pool.h>
 #include <powertask/storage.h>
 
-#define TASK_SCHEDULER_MAX_NUMBER_OF_TASKS 255
+#ifdef POWERTASK_CONFIG_TRACE
+#include <powertask/trace.h>
+#define TRACE(_sched, _event, _task) powertask_trace_record((_sched)->trace, _event, _task)
+#else
+#define TRACE(_sched, _event, _task)
+#endif
+
 #define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
 
-/** @brief Current scheduler state*/
+/** @brief Value of the state marker while the task states in RAM are valid. */
+#define STATE_MARKER_VALID 0x5054534BU
+
+/** @brief Age at which tasks stop aging. Fits every powertask_count_t. */
+#define MAX_TASK_AGE 255
+
+/** @brief Energy supplying a scheduler run: a single energy source or a pool. */
+struct supply_s {
+    powertask_energy_source_t *energy_source; /**< Energy source, if not running from a pool. */
+    powertask_energy_pool_t *pool;            /**< Energy pool, if not running from a single source. */
+    powertask_task *reserving_task;           /**< Task holding the energy reservation. NULL if none. */
+    int reserved_energy;                      /**< Energy the other tasks may not use while the reservation holds. */
+    int available_energy;                     /**< Energy of the source, as sampled in this pass. */
+    bool sampled;                             /**< available_energy is up to date: no action ran since it was sampled. */
+};
+
+/** @brief Identifies the layout of the stored scheduler state. */
+#define CURRENT_STATE_VERSION 0x50540002U
+
+/** @brief Bit of a stored task state set when the task is complete. The other bits hold the task id. */
+#define TASK_STATE_COMPLETE (1UL << 31)
+#define TASK_STATE_ID(_id) ((_id) & ~TASK_STATE_COMPLETE)
+
+/** @brief Current scheduler state, built in a buffer of POWERTASK_STATE_SIZE(number of tasks) bytes */
 struct current_state_s {
-    bool tasks_state[TASK_SCHEDULER_MAX_NUMBER_OF_TASKS]; /**< Array containing current task states. */
-    int number_of_tasks; /**< Number of valid elements in tasks_state. */
+    uint32_t version; /**< Layout of the stored state (CURRENT_STATE_VERSION). */
+    uint32_t number_of_tasks; /**< Number of valid elements in tasks_state. */
+    uint32_t tasks_state[]; /**< Task ids, with TASK_STATE_COMPLETE set for complete tasks. */
 };
 
+_Static_assert(sizeof(struct current_state_s) == POWERTASK_STATE_SIZE(0), "unexpected stored state layout");
+
+/** @brief Number of words of the fallback state buffer. */
+#define FALLBACK_STATE_LEN (POWERTASK_STATE_SIZE(POWERTASK_CONFIG_MAX_TASKS) / sizeof(uint32_t))
+
+/** @brief Declares the buffer for the stored state of schedulers without their own. */
+#if POWERTASK_CONFIG_STATIC_STATE
+/** @brief Buffer shared by the schedulers without their own, to keep it off the stack. */
+static uint32_t fallback_state_buffer[FALLBACK_STATE_LEN];
+#define FALLBACK_STATE_BUFFER(_name) uint32_t *_name = fallback_state_buffer
+#else
+#define FALLBACK_STATE_BUFFER(_name) uint32_t _name[FALLBACK_STATE_LEN]
+#endif
+
 /* ------------------------------------------------------------------------------------------------------------------ */
 /*                                                    Private API                                                     */
 /* ------------------------------------------------------------------------------------------------------------------ */
 
+static int get_task_cost(powertask_task *task){
+    const powertask_task_info *info = POWERTASK_TASK_INFO(task);
+
+    return info->required_energy + (info->resource != NULL ? info->resource->setup_energy : 0);
+}
+
+/** @brief Energy the other tasks may not use while \p task holds the reservation. */
+static int get_reserved_energy(powertask_task *task){
+    const powertask_task_info *info = POWERTASK_TASK_INFO(task);
+
+    return info->reserved_energy > 0 ? info->reserved_energy : get_task_cost(task);
+}
+
+/** @brief Linear search for the cheapest pending task other than \p excluded, for schedulers without a cost index. */
+static powertask_task *find_cheapest_pending_task(powertask_scheduler *sched, powertask_task *excluded){
+    powertask_task *cheapest = NULL;
+
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        if(sched->list_of_tasks[i]->complete || sched->list_of_tasks[i] == excluded){
+            continue;
+        }
+
+        /* Equal costs keep the order of the list, as in the index. */
+        if(cheapest == NULL || get_task_cost(sched->list_of_tasks[i]) < get_task_cost(cheapest)){
+            cheapest = sched->list_of_tasks[i];
+        }
+    }
+
+    return cheapest;
+}
+
+/** @brief Recomputes the aggregates from the task states. Only needed when states are loaded from storage. */
+static void refresh_counters(powertask_scheduler *sched){
+    sched->_pending_tasks = 0;
+    sched->_cheapest_task = 0;
+    sched->_reserving_task = NULL;
+
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        sched->list_of_tasks[i]->_age = 0;
+
+        if(!sched->list_of_tasks[i]->complete){
+            sched->_pending_tasks++;
+        }
+    }
+}
+
+static void mark_task_complete(powertask_scheduler *sched, powertask_task *task){
+    task->complete = true;
+    task->_age = 0;
+    sched->_pending_tasks--;
+}
+
 static void reset_current_state(powertask_scheduler *sched){
     for(int i = 0; i < sched->number_of_tasks; i++){
         sched->list_of_tasks[i]->complete = false;
     }
-}
 
-static void save_current_state(powertask_scheduler *sched){
-    struct current_state_s to_save;
+    sched->_pending_tasks = sched->number_of_tasks;
+    sched->_cheapest_task = 0;
+    sched->_reserving_task = NULL;
+}
 
-    if(sched->number_of_tasks > ARRAY_LENGTH(to_save.tasks_state)){
+static void save_state(powertask_scheduler *sched, struct current_state_s *to_save, int capacity){
+    if(sched->number_of_tasks > capacity){
         /* TODO: Review this behaviour. Does it make sense to simply not
          * store the current state? This changes the expected behaviour of the
          * program.
@@ -35,89 +137,584 @@ static void save_current_state(powertask_scheduler *sched){
         return;
     }
 
-    to_save.number_of_tasks = sched->number_of_tasks;
+    to_save->version = CURRENT_STATE_VERSION;
+    to_save->number_of_tasks = sched->number_of_tasks;
 
     for(int i = 0; i < sched->number_of_tasks; i++){
-        to_save.tasks_state[i] = sched->list_of_tasks[i]->complete;
+        to_save->tasks_state[i] = TASK_STATE_ID(sched->list_of_tasks[i]->id);
+
+        if(sched->list_of_tasks[i]->complete){
+            to_save->tasks_state[i] |= TASK_STATE_COMPLETE;
+        }
     }
 
-    powertask_storage_save(&to_save, sizeof(struct current_state_s));
+    powertask_storage_save(to_save, POWERTASK_STATE_SIZE(sched->number_of_tasks));
+
+    TRACE(sched, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK);
 }
 
-static void load_current_state(powertask_scheduler *sched){
+static int compare_task_states(const void *a, const void *b){
+    uint32_t id_a = TASK_STATE_ID(*(const uint32_t *)a);
+    uint32_t id_b = TASK_STATE_ID(*(const uint32_t *)b);
+
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+/**
+ * @brief Checks if the stored states are in the order of the list
+ * 
+ * @details Tasks usually keep their position, so the states can then be
+ * restored by position, in linear time.
+ */
+static bool is_stored_in_list_order(powertask_scheduler *sched, struct current_state_s *loaded){
+    if(loaded->number_of_tasks != (uint32_t)sched->number_of_tasks){
+        return false;
+    }
+
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        if(TASK_STATE_ID(loaded->tasks_state[i]) != TASK_STATE_ID(sched->list_of_tasks[i]->id)){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads the stored state and restores the task states from it
+ * 
+ * @return 0, if the state was loaded (or there was none to restore)
+ * @return -ENOSPC the stored state holds more tasks than \p capacity.
+ */
+static int load_state(powertask_scheduler *sched, struct current_state_s *loaded, int capacity){
     int err = 0;
-    struct current_state_s loaded;
-    
-    err = powertask_storage_load(&loaded, sizeof(struct current_state_s));
-    
-    if(err < 0){
+    powertask_task *task;
+    uint32_t key;
+    const uint32_t *task_state;
+
+    err = powertask_storage_load(loaded, POWERTASK_STATE_SIZE(capacity));
+
+    if(err == -ENOSPC){
+        return err;
+    }
+
+    if(err < 0 || loaded->version != CURRENT_STATE_VERSION){
+        return 0;
+    }
+
+    if(loaded->number_of_tasks > (uint32_t)capacity){
+        return -ENOSPC;
+    }
+
+    if(is_stored_in_list_order(sched, loaded)){
+        for(int i = 0; i < sched->number_of_tasks; i++){
+            sched->list_of_tasks[i]->complete = (loaded->tasks_state[i] & TASK_STATE_COMPLETE) != 0;
+        }
+        return 0;
+    }
+
+    /* Tasks without an id are restored by position, before the states are reordered. */
+    for(int i = 0; i < sched->number_of_tasks && i < (int)loaded->number_of_tasks; i++){
+        if(TASK_STATE_ID(sched->list_of_tasks[i]->id) == 0 && TASK_STATE_ID(loaded->tasks_state[i]) == 0){
+            sched->list_of_tasks[i]->complete = (loaded->tasks_state[i] & TASK_STATE_COMPLETE) != 0;
+        }
+    }
+
+    /* Tasks were added, removed or reordered: sort the states by id, so each task is found in log time. */
+    qsort(loaded->tasks_state, loaded->number_of_tasks, sizeof(uint32_t), compare_task_states);
+
+    /* States of tasks that no longer exist are dropped. New tasks stay pending. */
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        task = sched->list_of_tasks[i];
+        key = TASK_STATE_ID(task->id);
+
+        if(key == 0){
+            continue;
+        }
+
+        task_state = bsearch(&key, loaded->tasks_state, loaded->number_of_tasks, sizeof(uint32_t), compare_task_states);
+
+        if(task_state != NULL){
+            task->complete = (*task_state & TASK_STATE_COMPLETE) != 0;
+        }
+    }
+
+    return 0;
+}
+
+/* The fallback buffer is only declared in these functions, so that it is not on the stack otherwise. */
+static void save_state_from_fallback(powertask_scheduler *sched){
+    FALLBACK_STATE_BUFFER(buffer);
+
+    save_state(sched, (struct current_state_s *)buffer, POWERTASK_CONFIG_MAX_TASKS);
+}
+
+static void load_state_from_fallback(powertask_scheduler *sched){
+    FALLBACK_STATE_BUFFER(buffer);
+
+    (void)load_state(sched, (struct current_state_s *)buffer, POWERTASK_CONFIG_MAX_TASKS);
+}
+
+/** @brief Number of task states the buffer of the scheduler can hold */
+static int state_capacity(powertask_scheduler *sched){
+    if(sched->_list_of_tasks_len > POWERTASK_CONFIG_MAX_TASKS){
+        return POWERTASK_CONFIG_MAX_TASKS;
+    }
+
+    return sched->_list_of_tasks_len;
+}
+
+static void save_current_state(powertask_scheduler *sched){
+    if(sched->_state_buffer == NULL){
+        save_state_from_fallback(sched);
         return;
     }
 
-    if(loaded.number_of_tasks > sched->_list_of_tasks_len){
+    save_state(sched, (struct current_state_s *)sched->_state_buffer, state_capacity(sched));
+}
+
+static void load_stored_state(powertask_scheduler *sched){
+    /* The stored state outgrows the buffer of the scheduler when tasks were removed by an update. */
+    if(sched->_state_buffer == NULL ||
+       load_state(sched, (struct current_state_s *)sched->_state_buffer, state_capacity(sched)) == -ENOSPC){
+        load_state_from_fallback(sched);
+    }
+}
+
+static void load_current_state(powertask_scheduler *sched){
+    /* Warm boot: RAM was not lost since the last run, so it is up to date. */
+    if(sched->_state_marker == STATE_MARKER_VALID){
         return;
     }
 
-    for(int i = 0; i < loaded.number_of_tasks; i++){
-        sched->list_of_tasks[i]->complete = loaded.tasks_state[i];
+    sched->_state_marker = STATE_MARKER_VALID;
+
+    TRACE(sched, POWERTASK_TRACE_RESET, POWERTASK_TRACE_NO_TASK);
+
+    load_stored_state(sched);
+    refresh_counters(sched);
+}
+
+static int activate_task(powertask_scheduler *sched, powertask_task *task){
+    int err;
+
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        if(sched->list_of_tasks[i] != task){
+            continue;
+        }
+
+        if(task->complete){
+            task->complete = false;
+            sched->_pending_tasks++;
+            sched->_cheapest_task = 0;
+        }
+        return 0;
     }
+
+    err = powertask_add(sched, task);
+
+    /* The task is only changed once it is in the scheduler. */
+    if(err == 0 && task->complete){
+        task->complete = false;
+        sched->_pending_tasks++;
+    }
+
+    return err;
 }
 
-/* ------------------------------------------------------------------------------------------------------------------ */
-/*                                                     Public API                                                     */
-/* ------------------------------------------------------------------------------------------------------------------ */
+static void drain_submissions(powertask_scheduler *sched){
+    powertask_task *task;
 
-void powertask_add(powertask_scheduler *sched, powertask_task *task){
-    if(sched->number_of_tasks >= sched->_list_of_tasks_len){
+    if(sched->submissions == NULL){
         return;
     }
-    sched->list_of_tasks[sched->number_of_tasks++] = task;
-    return;
+
+    while((task = powertask_queue_pop(sched->submissions)) != NULL){
+        /* The queue must keep draining, so a task that does not fit is counted rather than kept. */
+        if(activate_task(sched, task) == -ENOSPC && sched->_dropped_submissions < UINT32_MAX){
+            sched->_dropped_submissions++;
+        }
+    }
 }
 
-void powertask_run_scheduler(powertask_scheduler *sched, powertask_energy_source_t *energy_source){
+static bool is_reserving_energy(powertask_scheduler *sched, powertask_task *task){
+    if(POWERTASK_TASK_INFO(task)->reserved_energy > 0){
+        return true;
+    }
 
-    int i = 0;
-    int complete_tasks = 0;
+    return sched->aging_threshold > 0 && task->_age >= sched->aging_threshold;
+}
+
+/**
+ * @brief Picks the task holding the energy reservation of a run
+ * 
+ * @details Among the pending tasks reserving energy, the one that waited the
+ * longest and whose condition holds. Ties keep the order of the list.
+ */
+static void reserve_energy(powertask_scheduler *sched, struct supply_s *supply){
+    const powertask_task_info *info;
+    powertask_task *task;
+
+    supply->reserving_task = NULL;
+    supply->reserved_energy = 0;
+
+    for(int i = 0; i < sched->number_of_tasks; i++){
+        task = sched->list_of_tasks[i];
+        info = POWERTASK_TASK_INFO(task);
+
+        if(task->complete || !is_reserving_energy(sched, task)){
+            continue;
+        }
+
+        if(supply->reserving_task != NULL && task->_age <= supply->reserving_task->_age){
+            continue;
+        }
+
+        /* A task that cannot run yet must not hold back the tasks it waits for. */
+        if(info->condition != NULL && !info->condition()){
+            continue;
+        }
+
+        supply->reserving_task = task;
+        supply->reserved_energy = get_reserved_energy(task);
+    }
+}
+
+/**
+ * @brief Checks if the supply has more than the required energy
+ * 
+ * @return Index of the pool source to draw from (0 for a single energy source),
+ * or a negative value if there is not enough energy.
+ */
+static int get_supply_source(struct supply_s *supply, powertask_task *task, int required_energy){
+    if(supply->pool != NULL){
+        return powertask_pool_select(supply->pool, POWERTASK_TASK_INFO(task)->source, required_energy);
+    }
+
+    /* Skipping a task spends nothing, so a sample (e.g. a median batch) serves every task until an action runs. */
+    if(!supply->sampled){
+        supply->available_energy = powertask_get_available_energy(supply->energy_source);
+        supply->sampled = true;
+    }
+
+    return powertask_admit(supply->available_energy, required_energy) ? 0 : -ENOENT;
+}
+
+static bool run_task(powertask_scheduler *sched, int index, struct supply_s *supply){
+    powertask_task *task = sched->list_of_tasks[index];
+    const powertask_task_info *info = POWERTASK_TASK_INFO(task);
+    powertask_resource *resource = info->resource;
+    int required_energy = info->required_energy;
+    int source;
+
+    /* Powering the resource up is only paid by the first task of the window. */
+    if(resource != NULL && !resource->_powered){
+        required_energy += resource->setup_energy;
+    }
+
+    if(supply->reserving_task != NULL && supply->reserving_task != task){
+        required_energy += supply->reserved_energy;
+    }
+
+    source = get_supply_source(supply, task, required_energy);
+
+    if(source < 0){
+        /* The holder does not age, so the tasks it holds back can take over. */
+        if(task != supply->reserving_task && task->_age < MAX_TASK_AGE){
+            task->_age++;
+        }
+        TRACE(sched, POWERTASK_TRACE_SKIPPED_ENERGY, POWERTASK_TRACE_TASK_ID(task->id));
+        return false;
+    }
+
+    /* The condition of the holder already held when the reservation was made this run. */
+    if(info->condition != NULL && task != supply->reserving_task) {
+        if(!info->condition()){
+            TRACE(sched, POWERTASK_TRACE_SKIPPED_CONDITION, POWERTASK_TRACE_TASK_ID(task->id));
+            return false;
+        }
+    }
+
+    TRACE(sched, POWERTASK_TRACE_ADMITTED, POWERTASK_TRACE_TASK_ID(task->id));
+
+    if(supply->pool != NULL && supply->pool->sources[source].select != NULL){
+        supply->pool->sources[source].select();
+    }
+
+    if(resource != NULL && !resource->_powered){
+        if(resource->setup != NULL){
+            resource->setup();
+        }
+        resource->_powered = true;
+    }
+
+    if(info->action != NULL){
+        info->action();
+    }
+
+    supply->sampled = false;
+
+    mark_task_complete(sched, task);
+
+    if(task == supply->reserving_task){
+        supply->reserving_task = NULL;
+        supply->reserved_energy = 0;
+    }
+
+    TRACE(sched, POWERTASK_TRACE_COMPLETED, POWERTASK_TRACE_TASK_ID(task->id));
+
+    return true;
+}
+
+static bool is_first_resource_user(powertask_scheduler *sched, int index){
+    powertask_resource *resource = POWERTASK_TASK_INFO(sched->list_of_tasks[index])->resource;
+
+    for(int i = 0; i < index; i++){
+        if(POWERTASK_TASK_INFO(sched->list_of_tasks[i])->resource == resource){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int run_resource_window(powertask_scheduler *sched, int first, struct supply_s *supply){
+    powertask_resource *resource = POWERTASK_TASK_INFO(sched->list_of_tasks[first])->resource;
     powertask_task *current_task;
+    int executed_tasks = 0;
 
-    if(sched == NULL || energy_source == NULL){
-        return;
+    for(int i = first; i < sched->number_of_tasks; i++){
+        current_task = sched->list_of_tasks[i];
+
+        if(POWERTASK_TASK_INFO(current_task)->resource != resource || current_task->complete){
+            continue;
+        }
+
+        if(run_task(sched, i, supply)){
+            executed_tasks++;
+        }
+    }
+
+    if(resource->_powered){
+        if(resource->teardown != NULL){
+            resource->teardown();
+        }
+        resource->_powered = false;
     }
 
+    return executed_tasks;
+}
+
+static int run_scheduler(powertask_scheduler *sched, struct supply_s *supply){
+
+    int i = 0;
+    int executed_tasks = 0;
+    powertask_task *current_task;
+
     load_current_state(sched);
+    drain_submissions(sched);
+    reserve_energy(sched, supply);
 
     for(;i < sched->number_of_tasks; i++){
         current_task = sched->list_of_tasks[i];
 
+        if(POWERTASK_TASK_INFO(current_task)->resource != NULL){
+            if(is_first_resource_user(sched, i)){
+                executed_tasks += run_resource_window(sched, i, supply);
+            }
+            continue;
+        }
+
         if(current_task->complete){
-            complete_tasks++;
             continue;
         }
 
-        int available_energy = powertask_get_available_energy(energy_source);
+        if(run_task(sched, i, supply)){
+            executed_tasks++;
+        }
+    }
 
-        if(available_energy <= current_task->required_energy){
-            continue;
+    /* Kept for the energy queries between runs. */
+    sched->_reserving_task = supply->reserving_task;
+
+    if(sched->_pending_tasks == 0){
+        reset_current_state(sched);
+    }
+
+    save_current_state(sched);
+
+    return executed_tasks;
+}
+
+/** @brief Cheapest pending task other than \p excluded. */
+static powertask_task *find_pending_task_except(powertask_scheduler *sched, powertask_task *excluded){
+    powertask_task *task;
+
+    if(sched->_tasks_by_cost == NULL){
+        return find_cheapest_pending_task(sched, excluded);
+    }
+
+    for(int i = sched->_cheapest_task; i < sched->number_of_tasks; i++){
+        task = sched->list_of_tasks[sched->_tasks_by_cost[i]];
+
+        if(!task->complete && task != excluded){
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+void powertask_invalidate_state(powertask_scheduler *sched){
+    if(sched == NULL){
+        return;
+    }
+    sched->_state_marker = 0;
+}
+
+int powertask_add(powertask_scheduler *sched, powertask_task *task){
+    int i;
+
+    if(sched == NULL || task == NULL){
+        return -EINVAL;
+    }
+
+    if(sched->number_of_tasks >= sched->_list_of_tasks_len){
+        return -ENOSPC;
+    }
+
+    /* Stored states are matched by id, so tasks sharing one would restore each other's state. Id 0 is no id. */
+    for(i = 0; i < sched->number_of_tasks && TASK_STATE_ID(task->id) != 0; i++){
+        if(TASK_STATE_ID(sched->list_of_tasks[i]->id) == TASK_STATE_ID(task->id)){
+            return -EEXIST;
         }
+    }
 
-        if(current_task->condition != NULL) {
-            if(!current_task->condition()){
-                continue;
+    /* Keep the index sorted by cost. Equal costs keep the order of the list. */
+    if(sched->_tasks_by_cost != NULL){
+        for(i = sched->number_of_tasks; i > 0; i--){
+            if(get_task_cost(sched->list_of_tasks[sched->_tasks_by_cost[i - 1]]) <= get_task_cost(task)){
+                break;
             }
+            sched->_tasks_by_cost[i] = sched->_tasks_by_cost[i - 1];
         }
+        sched->_tasks_by_cost[i] = sched->number_of_tasks;
+        sched->_cheapest_task = 0;
+    }
 
-        if(current_task->action != NULL){
-            current_task->action();
-        }
-        
-        current_task->complete = true;
-        complete_tasks++;
+    if(!task->complete){
+        sched->_pending_tasks++;
     }
 
-    if(complete_tasks == sched->number_of_tasks){
-        reset_current_state(sched);
+    sched->list_of_tasks[sched->number_of_tasks++] = task;
+    return 0;
+}
+
+int powertask_submit(powertask_scheduler *sched, powertask_task *task){
+    if(sched == NULL || sched->submissions == NULL){
+        return -EINVAL;
     }
 
-    save_current_state(sched);
+    return powertask_queue_push(sched->submissions, task);
+}
+
+int powertask_get_dropped_submissions(powertask_scheduler *sched){
+    if(sched == NULL){
+        return -EINVAL;
+    }
+
+    return sched->_dropped_submissions > INT_MAX ? INT_MAX : (int)sched->_dropped_submissions;
+}
+
+int powertask_get_pending_tasks(powertask_scheduler *sched){
+    if(sched == NULL){
+        return -EINVAL;
+    }
+
+    return sched->_pending_tasks;
+}
+
+powertask_task *powertask_get_cheapest_pending_task(powertask_scheduler *sched){
+    if(sched == NULL){
+        return NULL;
+    }
+
+    if(sched->_tasks_by_cost == NULL){
+        return find_cheapest_pending_task(sched, NULL);
+    }
+
+    /* Tasks only complete during a round, so the cursor only moves forward until the next reset. */
+    while(sched->_cheapest_task < sched->number_of_tasks &&
+          sched->list_of_tasks[sched->_tasks_by_cost[sched->_cheapest_task]]->complete){
+        sched->_cheapest_task++;
+    }
+
+    if(sched->_cheapest_task == sched->number_of_tasks){
+        return NULL;
+    }
+
+    return sched->list_of_tasks[sched->_tasks_by_cost[sched->_cheapest_task]];
+}
+
+int powertask_get_cheapest_pending_energy(powertask_scheduler *sched){
+    powertask_task *cheapest;
+    powertask_task *holder;
+    int energy;
+
+    if(sched == NULL){
+        return -EINVAL;
+    }
+
+    cheapest = powertask_get_cheapest_pending_task(sched);
+
+    if(cheapest == NULL){
+        return -ENOENT;
+    }
+
+    holder = sched->_reserving_task;
+
+    if(holder == NULL || holder->complete){
+        return get_task_cost(cheapest);
+    }
+
+    /* While the reservation holds, the other tasks also need the reserved energy. */
+    if(cheapest == holder){
+        cheapest = find_pending_task_except(sched, holder);
+    }
+
+    energy = get_task_cost(holder);
+
+    if(cheapest != NULL && get_task_cost(cheapest) + get_reserved_energy(holder) < energy){
+        energy = get_task_cost(cheapest) + get_reserved_energy(holder);
+    }
+
+    return energy;
+}
+
+int powertask_run_scheduler(powertask_scheduler *sched, powertask_energy_source_t *energy_source){
+    struct supply_s supply = {
+        .energy_source = energy_source,
+    };
+
+    if(sched == NULL || energy_source == NULL){
+        return -EINVAL;
+    }
+
+    return run_scheduler(sched, &supply);
+}
+
+int powertask_run_scheduler_pool(powertask_scheduler *sched, powertask_energy_pool_t *pool){
+    struct supply_s supply = {
+        .pool = pool,
+    };
+
+    if(sched == NULL || pool == NULL){
+        return -EINVAL;
+    }
+
+    return run_scheduler(sched, &supply);
 }
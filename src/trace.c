@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <errno.h>
+
+#include <powertask/trace.h>
+#include <powertask/storage.h>
+
+/** @brief Hash of a pass without events. */
+#define PASS_HASH_INIT 2166136261U
+
+/** @brief Offset, within the trace region, of a record slot. */
+#define RECORD_OFFSET(_slot) (sizeof(powertask_trace_header_t) + (_slot) * sizeof(powertask_trace_record_t))
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Private API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Skips repeat every pass while the scheduler waits, so they may wait for the flush interval. */
+static bool is_urgent(powertask_trace_event_t event){
+    return event != POWERTASK_TRACE_SKIPPED_ENERGY && event != POWERTASK_TRACE_SKIPPED_CONDITION &&
+           event != POWERTASK_TRACE_CHECKPOINT;
+}
+
+/** @brief Add an event to the hash of a pass (FNV-1a, as powertask_task_id()). */
+static uint32_t hash_event(uint32_t hash, powertask_trace_event_t event, uint32_t task){
+    const uint8_t bytes[] = {(uint8_t)event, (uint8_t)task, (uint8_t)(task >> 8), (uint8_t)(task >> 16),
+                             (uint8_t)(task >> 24)};
+
+    for(size_t i = 0; i < sizeof(bytes); i++){
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/** @brief Records of the current pass are no longer in the batch, so it cannot be merged into the previous one. */
+static void drop_batch(powertask_trace_t *trace){
+    trace->_batched = 0;
+    trace->_pass_start = 0;
+    trace->_pass_split = trace->_pass_events > 0;
+}
+
+static int add_record(powertask_trace_t *trace, powertask_trace_event_t event, uint32_t task){
+    powertask_trace_record_t *record;
+    int err = 0;
+
+    /* Only the previous record of the pass is merged into, so that the timeline keeps its order. A repeated pass
+     * record is the exception: it is what the next repeated pass merges into. */
+    if(trace->_batched > 0 && (trace->_batched > trace->_pass_start || event == POWERTASK_TRACE_REPEATED)){
+        record = &trace->batch[trace->_batched - 1];
+
+        if(record->event == event && record->task == task){
+            if(record->count < UINT16_MAX){
+                record->count++;
+            }
+
+            return 0;
+        }
+    }
+
+    if(trace->_batched == trace->batch_len){
+        err = powertask_trace_flush(trace);
+        if(err < 0){
+            /* Keep the newest events: drop the batch rather than stop tracing. */
+            drop_batch(trace);
+        }
+    }
+
+    trace->batch[trace->_batched++] = (powertask_trace_record_t){
+        .event = event,
+        .task = task,
+        .count = 1,
+    };
+
+    return err;
+}
+
+static void load_header(powertask_trace_t *trace){
+    powertask_trace_header_t *header = &trace->_header;
+    int err;
+
+    if(trace->_loaded){
+        return;
+    }
+
+    err = powertask_storage_trace_read(0, header, sizeof(powertask_trace_header_t));
+
+    /* A ring of another capacity cannot be resumed: its records would be decoded with the wrong modulus. */
+    if(err < 0 || header->magic != POWERTASK_TRACE_MAGIC || header->capacity != trace->capacity ||
+       header->head >= trace->capacity || header->used > trace->capacity){
+        *header = (powertask_trace_header_t){
+            .magic = POWERTASK_TRACE_MAGIC,
+            .capacity = trace->capacity,
+        };
+    }
+
+    trace->_loaded = true;
+}
+
+static int write_records(powertask_trace_t *trace, const powertask_trace_record_t *records, uint16_t number_of_records){
+    powertask_trace_header_t *header = &trace->_header;
+    uint16_t until_wrap;
+    int err;
+
+    /* Only the newest records survive when a batch is larger than the ring. */
+    if(number_of_records > trace->capacity){
+        records += number_of_records - trace->capacity;
+        number_of_records = trace->capacity;
+    }
+
+    until_wrap = trace->capacity - header->head;
+    if(until_wrap > number_of_records){
+        until_wrap = number_of_records;
+    }
+
+    err = powertask_storage_trace_write(RECORD_OFFSET(header->head), records,
+                                        until_wrap * sizeof(powertask_trace_record_t));
+    if(err < 0){
+        return err;
+    }
+
+    if(number_of_records > until_wrap){
+        err = powertask_storage_trace_write(RECORD_OFFSET(0), records + until_wrap,
+                                            (number_of_records - until_wrap) * sizeof(powertask_trace_record_t));
+        if(err < 0){
+            return err;
+        }
+    }
+
+    header->head = (header->head + number_of_records) % trace->capacity;
+    header->used = header->used + number_of_records > trace->capacity ? trace->capacity
+                                                                     : header->used + number_of_records;
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_trace_flush(powertask_trace_t *trace){
+    int err;
+
+    if(trace == NULL || trace->capacity == 0){
+        return -EINVAL;
+    }
+
+    if(trace->_batched == 0){
+        return 0;
+    }
+
+    load_header(trace);
+
+    err = write_records(trace, trace->batch, trace->_batched);
+    if(err < 0){
+        return err;
+    }
+
+    err = powertask_storage_trace_write(0, &trace->_header, sizeof(powertask_trace_header_t));
+    if(err < 0){
+        return err;
+    }
+
+    drop_batch(trace);
+    trace->_checkpoints = 0;
+    trace->_urgent = false;
+
+    return 0;
+}
+
+int powertask_trace_record(powertask_trace_t *trace, powertask_trace_event_t event, uint32_t task){
+    int err = 0;
+
+    if(trace == NULL || trace->batch == NULL || trace->batch_len == 0){
+        return -EINVAL;
+    }
+
+    if(trace->_pass_events == 0){
+        trace->_pass_hash = PASS_HASH_INIT;
+    }
+
+    trace->_pass_hash = hash_event(trace->_pass_hash, event, task);
+    if(trace->_pass_events < UINT16_MAX){
+        trace->_pass_events++;
+    }
+
+    trace->_pass_urgent |= is_urgent(event);
+    trace->_urgent |= is_urgent(event);
+
+    err = add_record(trace, event, task);
+
+    if(event == POWERTASK_TRACE_CHECKPOINT){
+        /* An idle scheduler repeats the same skips every pass: only count them. */
+        if(!trace->_pass_urgent && !trace->_pass_split && trace->_pass_events == trace->_previous_events &&
+           trace->_pass_hash == trace->_previous_hash){
+            trace->_batched = trace->_pass_start;
+            err = add_record(trace, POWERTASK_TRACE_REPEATED, POWERTASK_TRACE_NO_TASK);
+        }
+
+        trace->_previous_hash = trace->_pass_hash;
+        trace->_previous_events = trace->_pass_events;
+        trace->_pass_events = 0;
+        trace->_pass_urgent = false;
+        trace->_pass_split = false;
+        trace->_pass_start = trace->_batched;
+        trace->_checkpoints++;
+
+        if(trace->_urgent || trace->_checkpoints >= trace->flush_interval){
+            err = powertask_trace_flush(trace);
+        }
+    } else if(event == POWERTASK_TRACE_ADMITTED){
+        /* The action may not return before the next power failure. */
+        err = powertask_trace_flush(trace);
+    }
+
+    return err;
+}
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <powertask/trace.h>
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Public API                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+int powertask_trace_decode(const void *region, size_t size,
+                           int (*callback)(const powertask_trace_record_t *record, void *ctx), void *ctx){
+    const powertask_trace_record_t *records;
+    powertask_trace_header_t header;
+    size_t capacity;
+    size_t oldest;
+
+    if(region == NULL || callback == NULL || size < sizeof(powertask_trace_header_t)){
+        return -EINVAL;
+    }
+
+    memcpy(&header, region, sizeof(powertask_trace_header_t));
+
+    /* The dump may be padded (e.g. to a flash page), so its size only bounds the capacity. */
+    capacity = header.capacity;
+
+    if(header.magic != POWERTASK_TRACE_MAGIC || capacity == 0 || size < POWERTASK_TRACE_REGION_SIZE(capacity) ||
+       header.head >= capacity || header.used > capacity){
+        return -EINVAL;
+    }
+
+    records = (const powertask_trace_record_t *)((const char *)region + sizeof(powertask_trace_header_t));
+    oldest = (header.head + capacity - header.used) % capacity;
+
+    for(size_t i = 0; i < header.used; i++){
+        if(callback(&records[(oldest + i) % capacity], ctx) != 0){
+            return (int)i + 1;
+        }
+    }
+
+    return header.used;
+}
+
+const char *powertask_trace_event_name(int event){
+    switch(event){
+    case POWERTASK_TRACE_RESET:
+        return "reset";
+    case POWERTASK_TRACE_ADMITTED:
+        return "admitted";
+    case POWERTASK_TRACE_SKIPPED_ENERGY:
+        return "skipped-energy";
+    case POWERTASK_TRACE_SKIPPED_CONDITION:
+        return "skipped-condition";
+    case POWERTASK_TRACE_COMPLETED:
+        return "completed";
+    case POWERTASK_TRACE_CHECKPOINT:
+        return "checkpoint";
+    case POWERTASK_TRACE_REPEATED:
+        return "repeated";
+    default:
+        return "unknown";
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <errno.h>
 
 extern "C"
 {
@@ -86,4 +87,278 @@ TEST(test_energy_regular, test_energy_get_available){
 
     mock().expectOneCall("get_voltage").andReturnValue(fake_voltage);
     CHECK_EQUAL(powertask_get_available_energy(&energy_source), expected_available_energy);
-}
\ No newline at end of file
+}
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                      Internal variables - test_energy_sampler                                      */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Samples returned by the fake read samples function */
+static const int *fake_samples;
+
+/** @brief Mock read samples function behaviour */
+int fake_read_samples(int *buffer, size_t number_of_samples){
+    for(size_t i = 0; i < number_of_samples; i++){
+        buffer[i] = *fake_samples++;
+    }
+    return mock().actualCall("read_samples").returnIntValue();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Unit Tests - test_energy_sampler                                            */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Energy - Median filter
+ * 
+ * The scope of this unit test is to validate if the median filter takes a
+ * full batch of samples in a single read and rejects outliers.
+ * 
+ * It is expected the reported voltage to be the median of the batch.
+ */
+TEST(test_energy_regular, test_energy_sampler_median){
+    const int samples[] = {3300, 900, 3310, 5000, 3290};
+    int buffer[5];
+
+    powertask_sampler_t sampler = {
+        .read_samples = fake_read_samples,
+        .buffer = buffer,
+        .buffer_len = 5,
+        .filter = POWERTASK_FILTER_MEDIAN,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .sampler = &sampler,
+    };
+
+    fake_samples = samples;
+    mock().expectOneCall("read_samples").andReturnValue(0);
+
+    CHECK_EQUAL(3300, powertask_get_voltage(&energy_source));
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - EWMA filter
+ * 
+ * The scope of this unit test is to validate if the EWMA filter is primed with
+ * the first sample and then smooths the following ones, requesting a single
+ * conversion per read.
+ * 
+ * It is expected the reported voltage to follow the moving average.
+ */
+TEST(test_energy_regular, test_energy_sampler_ewma){
+    const int samples[] = {3000, 3400};
+
+    powertask_sampler_t sampler = {
+        .read_samples = fake_read_samples,
+        .filter = POWERTASK_FILTER_EWMA,
+        .ewma_shift = 2,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .sampler = &sampler,
+    };
+
+    fake_samples = samples;
+    mock().expectNCalls(2, "read_samples").andReturnValue(0);
+
+    CHECK_EQUAL(3000, powertask_get_voltage(&energy_source));
+    CHECK_EQUAL(3100, powertask_get_voltage(&energy_source));
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - EWMA filter steady state
+ * 
+ * The scope of this unit test is to validate if the EWMA filter reaches a
+ * constant input that differs from its output by less than 2^ewma_shift mV.
+ * 
+ * It is expected the reported voltage to settle on the input voltage.
+ */
+TEST(test_energy_regular, test_energy_sampler_ewma_steady_state){
+    const int samples[] = {3000, 3003, 3003, 3003, 3003, 3003, 3003, 3003, 3003, 3003};
+    int voltage = 0;
+
+    powertask_sampler_t sampler = {
+        .read_samples = fake_read_samples,
+        .filter = POWERTASK_FILTER_EWMA,
+        .ewma_shift = 2,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .sampler = &sampler,
+    };
+
+    fake_samples = samples;
+    mock().expectNCalls(10, "read_samples").andReturnValue(0);
+
+    for(int i = 0; i < 10; i++){
+        voltage = powertask_get_voltage(&energy_source);
+    }
+
+    CHECK_EQUAL(3003, voltage);
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - Sampler initialization
+ * 
+ * The scope of this unit test is to validate if the sampler parameters are
+ * checked on initialization.
+ * 
+ * It is expected EWMA smoothing factors out of range to be rejected.
+ */
+TEST(test_energy_regular, test_energy_sampler_init){
+    powertask_sampler_t sampler = {
+        .filter = POWERTASK_FILTER_EWMA,
+        .ewma_shift = 4,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .get_voltage = fake_get_voltage,
+        .sampler = &sampler,
+    };
+
+    CHECK_EQUAL(0, powertask_sampler_init(&sampler));
+
+    sampler.ewma_shift = -1;
+    CHECK_EQUAL(-EINVAL, powertask_sampler_init(&sampler));
+    CHECK_EQUAL(-EINVAL, powertask_get_voltage(&energy_source));
+
+    sampler.ewma_shift = POWERTASK_SAMPLER_MAX_EWMA_SHIFT + 1;
+    CHECK_EQUAL(-EINVAL, powertask_sampler_init(&sampler));
+
+    sampler.filter = POWERTASK_FILTER_MEDIAN;
+    CHECK_EQUAL(-EINVAL, powertask_sampler_init(&sampler));
+
+    CHECK_EQUAL(-EINVAL, powertask_sampler_init(NULL));
+}
+
+/**
+ * @brief Energy - Hysteresis band
+ * 
+ * The scope of this unit test is to validate if changes within the hysteresis
+ * band are not reported.
+ * 
+ * It is expected the reported voltage to change only when the filtered voltage
+ * leaves the band around the last reported value.
+ */
+TEST(test_energy_regular, test_energy_sampler_hysteresis){
+    const int samples[] = {3000, 3040, 2960, 3060};
+
+    powertask_sampler_t sampler = {
+        .read_samples = fake_read_samples,
+        .filter = POWERTASK_FILTER_NONE,
+        .hysteresis = 50,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .sampler = &sampler,
+    };
+
+    fake_samples = samples;
+    mock().expectNCalls(4, "read_samples").andReturnValue(0);
+
+    CHECK_EQUAL(3000, powertask_get_voltage(&energy_source));
+    CHECK_EQUAL(3000, powertask_get_voltage(&energy_source));
+    CHECK_EQUAL(3000, powertask_get_voltage(&energy_source));
+    CHECK_EQUAL(3060, powertask_get_voltage(&energy_source));
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - Sampler without buffer callback
+ * 
+ * The scope of this unit test is to validate if the sampler falls back to the
+ * energy source get_voltage function when no buffer callback is given.
+ * 
+ * It is expected get_voltage to be called once per sample in the batch.
+ */
+TEST(test_energy_regular, test_energy_sampler_get_voltage_fallback){
+    int buffer[3];
+
+    powertask_sampler_t sampler = {
+        .buffer = buffer,
+        .buffer_len = 3,
+        .filter = POWERTASK_FILTER_MEDIAN,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .get_voltage = fake_get_voltage,
+        .sampler = &sampler,
+    };
+
+    mock().expectNCalls(3, "get_voltage").andReturnValue(2000);
+
+    CHECK_EQUAL(2000, powertask_get_voltage(&energy_source));
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - Sampler read failure
+ * 
+ * The scope of this unit test is to validate the behaviour of the function
+ * when the buffer callback fails or the median filter has no buffer.
+ * 
+ * It is expected to return an error code.
+ */
+TEST(test_energy_regular, test_energy_sampler_errors){
+    const int samples[] = {3000};
+
+    powertask_sampler_t sampler = {
+        .read_samples = fake_read_samples,
+        .filter = POWERTASK_FILTER_NONE,
+    };
+    powertask_energy_source_t energy_source = {
+        .capacitance = 1,
+        .sampler = &sampler,
+    };
+
+    fake_samples = samples;
+    mock().expectOneCall("read_samples").andReturnValue(-1);
+
+    CHECK(powertask_get_available_energy(&energy_source) < 0);
+
+    sampler.filter = POWERTASK_FILTER_MEDIAN;
+
+    CHECK(powertask_get_voltage(&energy_source) < 0);
+
+    mock().checkExpectations();
+}
+
+/**
+ * @brief Energy - Voltage for a given amount of energy
+ * 
+ * The scope of this unit test is to validate if the voltage threshold returned
+ * is the lowest one at which more than the requested energy is available.
+ * 
+ * It is expected the available energy at the threshold to exceed the requested
+ * energy, and one millivolt below it to not.
+ */
+TEST(test_energy_regular, test_energy_get_voltage_for_energy){
+    const int fake_capacitance = 1000;
+    const int energy = 1000;
+
+    powertask_energy_source_t energy_source = {
+        .capacitance = fake_capacitance,
+        .get_voltage = fake_get_voltage,
+    };
+
+    int threshold = powertask_get_voltage_for_energy(&energy_source, energy);
+
+    mock().expectOneCall("get_voltage").andReturnValue(threshold);
+    mock().expectOneCall("get_voltage").andReturnValue(threshold - 1);
+
+    CHECK(powertask_get_available_energy(&energy_source) > energy);
+    CHECK(powertask_get_available_energy(&energy_source) <= energy);
+
+    CHECK(powertask_get_voltage_for_energy(NULL, energy) < 0);
+    CHECK(powertask_get_voltage_for_energy(&energy_source, -1) < 0);
+
+    mock().checkExpectations();
+}
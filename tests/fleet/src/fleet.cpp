@@ -0,0 +1,209 @@
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
+
+extern "C"
+{
+	#include <powertask/fleet.h>
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_fleet_regular){
+	void setup(){
+
+	}
+
+	void teardown(){
+
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Internal variables - test_fleet_regular                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Task set with a single task */
+static const powertask_fleet_task_t single_task[] = {
+	{ .required_energy = 100, .cost = 100 },
+};
+
+/** @brief Task set where the first task waits for the second */
+static const powertask_fleet_task_t dependent_tasks[] = {
+	{ .required_energy = 10, .cost = 10, .wait_for = 1U << 1 },
+	{ .required_energy = 10, .cost = 10 },
+};
+
+/** @brief Task set spending more than its required energy */
+static const powertask_fleet_task_t underestimated_tasks[] = {
+	{ .required_energy = 10, .cost = 30 },
+	{ .required_energy = 10, .cost = 40 },
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                             Test cases - test_fleet_regular                                        */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Fleet - Initialization
+ * 
+ * The scope of this test is to validate if the nodes are reset and invalid
+ * fleets are rejected.
+ * 
+ * It is expected the costs to be set from the task set and invalid fleets to
+ * return an error code.
+ */
+TEST(test_fleet_regular, test_fleet_init)
+{
+	POWERTASK_FLEET_INIT(fleet, underestimated_tasks, ARRAY_LENGTH(underestimated_tasks), 3);
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+	CHECK_EQUAL(0, fleet.energy[2]);
+	CHECK_EQUAL(40, fleet.cost[POWERTASK_FLEET_INDEX(&fleet, 1, 2)]);
+	CHECK_EQUAL(10, fleet.learned_cost[POWERTASK_FLEET_INDEX(&fleet, 1, 2)]);
+
+	CHECK_EQUAL(-EINVAL, powertask_fleet_init(NULL));
+	CHECK_EQUAL(-EINVAL, powertask_fleet_step(NULL, NULL));
+
+	fleet.learning_shift = -1;
+	CHECK_EQUAL(-EINVAL, powertask_fleet_init(&fleet));
+
+	fleet.learning_shift = POWERTASK_FLEET_MAX_LEARNING_SHIFT + 1;
+	CHECK_EQUAL(-EINVAL, powertask_fleet_init(&fleet));
+
+	fleet.learning_shift = 0;
+	fleet.number_of_tasks = POWERTASK_FLEET_MAX_TASKS + 1;
+	CHECK_EQUAL(-EINVAL, powertask_fleet_init(&fleet));
+};
+
+/**
+ * @brief Fleet - Admission
+ * 
+ * The scope of this test is to validate if tasks are admitted with the rule of
+ * the scheduler: the available energy must be above the required energy.
+ * 
+ * It is expected the task to only run on the node harvesting more than its
+ * required energy, which completes a round.
+ */
+TEST(test_fleet_regular, test_fleet_admission)
+{
+	POWERTASK_FLEET_INIT(fleet, single_task, ARRAY_LENGTH(single_task), 2);
+	const int32_t harvest[] = { 101, 100 };
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+	CHECK_EQUAL(1, powertask_fleet_step(&fleet, harvest));
+
+	CHECK_EQUAL(1, fleet.energy[0]);
+	CHECK_EQUAL(100, fleet.energy[1]);
+	CHECK_EQUAL(1, fleet.rounds[0]);
+	CHECK_EQUAL(0, fleet.rounds[1]);
+	CHECK_EQUAL(0, fleet.complete[0]);
+};
+
+/**
+ * @brief Fleet - Tasks waiting for other tasks
+ * 
+ * The scope of this test is to validate if a task only runs once the tasks it
+ * waits for are complete.
+ * 
+ * It is expected the waiting task to run in the step after the other task.
+ */
+TEST(test_fleet_regular, test_fleet_wait_for)
+{
+	POWERTASK_FLEET_INIT(fleet, dependent_tasks, ARRAY_LENGTH(dependent_tasks), 1);
+	const int32_t harvest[] = { 100 };
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+
+	CHECK_EQUAL(1, powertask_fleet_step(&fleet, harvest));
+	CHECK_EQUAL(1U << 1, fleet.complete[0]);
+
+	CHECK_EQUAL(1, powertask_fleet_step(&fleet, NULL));
+	CHECK_EQUAL(0, fleet.complete[0]);
+	CHECK_EQUAL(1, fleet.rounds[0]);
+	CHECK_EQUAL(80, fleet.energy[0]);
+};
+
+/**
+ * @brief Fleet - Brownout
+ * 
+ * The scope of this test is to validate if a node spending more than its
+ * stored energy browns out.
+ * 
+ * It is expected the node to lose its energy and the progress of the step.
+ */
+TEST(test_fleet_regular, test_fleet_brownout)
+{
+	POWERTASK_FLEET_INIT(fleet, underestimated_tasks, ARRAY_LENGTH(underestimated_tasks), 1);
+	const int32_t harvest[] = { 61 };
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+	powertask_fleet_step(&fleet, harvest);
+
+	CHECK_EQUAL(1, fleet.brownouts[0]);
+	CHECK_EQUAL(0, fleet.energy[0]);
+	CHECK_EQUAL(0, fleet.complete[0]);
+	CHECK_EQUAL(0, fleet.rounds[0]);
+};
+
+/**
+ * @brief Fleet - Learned costs
+ * 
+ * The scope of this test is to validate if nodes learn the energy spent by the
+ * tasks and admit them by their learned cost.
+ * 
+ * It is expected the learned cost to converge to the spent energy and the task
+ * to not be admitted below it.
+ */
+TEST(test_fleet_regular, test_fleet_learned_cost)
+{
+	static const powertask_fleet_task_t tasks[] = {
+		{ .required_energy = 10, .cost = 50 },
+	};
+	POWERTASK_FLEET_INIT(fleet, tasks, ARRAY_LENGTH(tasks), 1);
+	const int32_t harvest[] = { 100 };
+	const int32_t small_harvest[] = { 35 };
+
+	fleet.learning_shift = 1;
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+
+	CHECK_EQUAL(1, powertask_fleet_step(&fleet, harvest));
+	CHECK_EQUAL(30, fleet.learned_cost[0]);
+
+	CHECK_EQUAL(1, powertask_fleet_step(&fleet, NULL));
+	CHECK_EQUAL(40, fleet.learned_cost[0]);
+	CHECK_EQUAL(0, fleet.energy[0]);
+
+	CHECK_EQUAL(0, powertask_fleet_step(&fleet, small_harvest));
+	CHECK_EQUAL(0, fleet.brownouts[0]);
+};
+
+/**
+ * @brief Fleet - Maximum energy
+ * 
+ * The scope of this test is to validate if harvest above the maximum energy of
+ * the nodes is lost.
+ * 
+ * It is expected the node energy to be capped.
+ */
+TEST(test_fleet_regular, test_fleet_max_energy)
+{
+	static const powertask_fleet_task_t tasks[] = {
+		{ .required_energy = 1000, .cost = 1000 },
+	};
+	POWERTASK_FLEET_INIT(fleet, tasks, ARRAY_LENGTH(tasks), 1);
+	const int32_t harvest[] = { 150 };
+
+	fleet.max_energy = 100;
+
+	CHECK_EQUAL(0, powertask_fleet_init(&fleet));
+	CHECK_EQUAL(0, powertask_fleet_step(&fleet, harvest));
+	CHECK_EQUAL(100, fleet.energy[0]);
+};
@@ -0,0 +1,6 @@
+/**
+ * @brief Clear fake powertask storage
+ * 
+ * @details Allows to erase the fake storage used in the unit tests.
+ */
+void fake_clear_powertask_storage(void);
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define MAX_FAKE_STORAGE_LEN 2048
+
+extern "C" {
+    static uint8_t fake_storage[MAX_FAKE_STORAGE_LEN];
+    static size_t fake_storage_used;
+
+    int powertask_storage_save(void *data_to_store, size_t size_of_data){
+
+        if (data_to_store == NULL || size_of_data == 0 || size_of_data > MAX_FAKE_STORAGE_LEN) {
+            return -EINVAL;
+        }
+
+        memcpy(fake_storage, data_to_store, size_of_data);
+        fake_storage_used = size_of_data;
+
+        return 0;
+    }
+
+    int powertask_storage_load(void *buffer, size_t size_of_buffer){
+
+        if (fake_storage_used == 0){
+            return -EINVAL;
+        }
+
+        if (fake_storage_used > size_of_buffer){
+            return -ENOSPC;
+        }
+
+        memcpy(buffer, fake_storage, fake_storage_used);
+
+        return 0;
+    }
+
+    void fake_clear_powertask_storage(void){
+        memset(fake_storage, 0, MAX_FAKE_STORAGE_LEN);
+        fake_storage_used = 0;
+    }
+}
@@ -0,0 +1,392 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <thread>
+#include <chrono>
+
+extern "C"
+{
+	#include <powertask/platform.h>
+	#include <powertask/port/linux.h>
+
+	#include "fake.h"
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_platform_regular){
+	void setup(){
+
+	}
+
+	void teardown(){
+		mock().clear();
+		fake_clear_powertask_storage();
+	}
+};
+
+TEST_GROUP(test_platform_linux){
+	powertask_platform_t platform;
+
+	void setup(){
+		platform = (powertask_platform_t){0};
+		CHECK_EQUAL(0, powertask_linux_init(&platform));
+	}
+
+	void teardown(){
+		powertask_linux_deinit();
+		mock().clear();
+		fake_clear_powertask_storage();
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                 Internal variables                                                 */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Voltage (in mV) returned by the fake energy source */
+static volatile int fake_voltage;
+
+/** @brief Number of loop iterations left before the loop is stopped */
+static int iterations_left;
+
+/** @brief Last armed voltage threshold */
+static int armed_voltage;
+
+/** @brief Last armed timer timeout */
+static int armed_timeout;
+
+/** @brief Fake voltage measurement */
+int fake_get_voltage(void){
+	return fake_voltage;
+}
+
+/** @brief Successful condition */
+bool condition_success() {
+	return true;
+}
+
+/** @brief Failing condition */
+bool condition_fails() {
+	return false;
+}
+
+/** @brief Action of the 1st task */
+void task1(){
+	mock().actualCall("task1");
+}
+
+/** @brief Action of the 2nd task */
+void task2(){
+	mock().actualCall("task2");
+}
+
+/** @brief Fake sleep */
+void fake_sleep(void){
+	mock().actualCall("sleep");
+}
+
+/** @brief Fake voltage wakeup */
+int fake_set_voltage_wakeup(int threshold){
+	armed_voltage = threshold;
+	return 0;
+}
+
+/** @brief Fake timer wakeup */
+int fake_set_timer_wakeup(int timeout){
+	armed_timeout = timeout;
+	return 0;
+}
+
+/** @brief Stops the loop after a number of iterations */
+bool fake_keep_running(void){
+	return iterations_left-- > 0;
+}
+
+/** @brief Fake platform */
+static powertask_platform_t fake_platform = {
+	.sleep = fake_sleep,
+	.set_voltage_wakeup = fake_set_voltage_wakeup,
+	.set_timer_wakeup = fake_set_timer_wakeup,
+	.idle_timeout = 100,
+	.keep_running = fake_keep_running,
+};
+
+/** @brief Energy source (E = V^2 / 2000) */
+static powertask_energy_source_t energy_src = {
+	.capacitance = 1000,
+	.get_voltage = fake_get_voltage,
+};
+
+/** @brief Elapsed time in ms since \p start */
+static long elapsed_ms(struct timespec *start){
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/** Tasks declaration */
+POWERTASK_DECLARE(task1);
+POWERTASK_DECLARE(task2);
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                         Unit Tests - test_platform_regular                                         */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Platform - run_forever with invalid arguments
+ * 
+ * The scope of this unit test is to validate if the loop is not entered when
+ * parameters are missing.
+ * 
+ * It is expected to return an error code.
+ */
+TEST(test_platform_regular, test_run_forever_invalid_arguments){
+	POWERTASK_INIT(scheduler, 1);
+	powertask_platform_t platform = {0};
+
+	CHECK(powertask_run_forever(NULL, &energy_src, &fake_platform) < 0);
+	CHECK(powertask_run_forever(&scheduler, NULL, &fake_platform) < 0);
+	CHECK(powertask_run_forever(&scheduler, &energy_src, NULL) < 0);
+	CHECK(powertask_run_forever(&scheduler, &energy_src, &platform) < 0);
+}
+
+/**
+ * @brief Platform - Scheduler makes progress
+ * 
+ * The scope of this unit test is to validate if the loop runs the scheduler
+ * again right away while tasks are being executed.
+ * 
+ * It is expected the task to be executed on every iteration, without sleeping.
+ */
+TEST(test_platform_regular, test_run_forever_progress_does_not_sleep){
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 1000);
+
+	fake_voltage = 2000;
+	iterations_left = 3;
+
+	mock().expectNCalls(3, "task1");
+	mock().expectNoCall("sleep");
+
+	CHECK_EQUAL(0, powertask_run_forever(&scheduler, &energy_src, &fake_platform));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Platform - Not enough energy
+ * 
+ * The scope of this unit test is to validate if the loop sleeps until enough
+ * energy is available for the cheapest pending task.
+ * 
+ * It is expected a voltage wakeup to be armed at the threshold above which the
+ * task can be executed, followed by a sleep.
+ */
+TEST(test_platform_regular, test_run_forever_sleeps_until_voltage){
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 1000);
+
+	fake_voltage = 1000;
+	iterations_left = 1;
+	armed_voltage = 0;
+
+	mock().expectNoCall("task1");
+	mock().expectOneCall("sleep");
+
+	CHECK_EQUAL(0, powertask_run_forever(&scheduler, &energy_src, &fake_platform));
+	CHECK_EQUAL(1415, armed_voltage);
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Platform - Tasks waiting on their conditions
+ * 
+ * The scope of this unit test is to validate if the loop sleeps for the idle
+ * timeout when there is enough energy but the tasks cannot be executed.
+ * 
+ * It is expected a timer wakeup to be armed, followed by a sleep.
+ */
+TEST(test_platform_regular, test_run_forever_sleeps_until_timer){
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, condition_fails, 1000);
+
+	fake_voltage = 2000;
+	iterations_left = 1;
+	armed_voltage = 0;
+	armed_timeout = 0;
+
+	mock().expectNoCall("task1");
+	mock().expectOneCall("sleep");
+
+	CHECK_EQUAL(0, powertask_run_forever(&scheduler, &energy_src, &fake_platform));
+	CHECK_EQUAL(0, armed_voltage);
+	CHECK_EQUAL(100, armed_timeout);
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Platform - Stored state is loaded before waiting
+ * 
+ * The scope of this unit test is to validate if the loop runs a first pass,
+ * loading the stored state, before waiting for the cheapest pending task.
+ * 
+ * It is expected the task completed before the reset to not be waited for, and
+ * the voltage wakeup to be armed for the task still pending.
+ */
+TEST(test_platform_regular, test_run_forever_loads_state_before_waiting){
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 1000);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 2000);
+
+	fake_voltage = 1500;
+
+	mock().expectOneCall("task1");
+	mock().expectNoCall("task2");
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate system reset. Reset current state of the tasks. */
+	task_task1.complete = false;
+	task_task2.complete = false;
+	powertask_invalidate_state(&scheduler);
+
+	fake_voltage = 1000;
+	iterations_left = 1;
+	armed_voltage = 0;
+
+	mock().expectNoCall("task1");
+	mock().expectNoCall("task2");
+	mock().expectOneCall("sleep");
+
+	CHECK_EQUAL(0, powertask_run_forever(&scheduler, &energy_src, &fake_platform));
+	CHECK_EQUAL(2001, armed_voltage);
+
+	mock().checkExpectations();
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                          Unit Tests - test_platform_linux                                          */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Linux port - Timer wakeup
+ * 
+ * The scope of this unit test is to validate if sleep returns once the armed
+ * timer expires.
+ * 
+ * It is expected sleep to last at least the armed timeout.
+ */
+TEST(test_platform_linux, test_linux_timer_wakeup){
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	CHECK_EQUAL(0, platform.set_timer_wakeup(20));
+	platform.sleep();
+
+	CHECK(elapsed_ms(&start) >= 19);
+}
+
+/**
+ * @brief Linux port - Voltage wakeup
+ * 
+ * The scope of this unit test is to validate if sleep returns once the voltage
+ * rises above the armed threshold, and not before.
+ * 
+ * It is expected a voltage below the threshold to not wake up the loop, and a
+ * voltage above it to wake up the loop before the backstop timer expires.
+ */
+TEST(test_platform_linux, test_linux_voltage_wakeup){
+	struct timespec start;
+
+	CHECK_EQUAL(0, platform.set_voltage_wakeup(3000));
+	CHECK_EQUAL(0, powertask_linux_notify_voltage(2900));
+	CHECK_EQUAL(0, platform.set_timer_wakeup(20));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	platform.sleep();
+	CHECK(elapsed_ms(&start) >= 19);
+
+	CHECK_EQUAL(0, platform.set_voltage_wakeup(3000));
+	CHECK_EQUAL(0, platform.set_timer_wakeup(5000));
+	CHECK_EQUAL(0, powertask_linux_notify_voltage(3100));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	platform.sleep();
+	CHECK(elapsed_ms(&start) < 1000);
+}
+
+/**
+ * @brief Linux port - Voltage wakeup disarms the timer
+ * 
+ * The scope of this unit test is to validate if the timer armed before a
+ * voltage wakeup does not end a later sleep that only waits for voltage.
+ * 
+ * It is expected the later sleep to last until the voltage is reported.
+ */
+TEST(test_platform_linux, test_linux_voltage_wakeup_disarms_timer){
+	struct timespec start;
+
+	CHECK_EQUAL(0, platform.set_timer_wakeup(20));
+	CHECK_EQUAL(0, platform.set_voltage_wakeup(3000));
+	CHECK_EQUAL(0, powertask_linux_notify_voltage(3100));
+	platform.sleep();
+
+	CHECK_EQUAL(0, platform.set_voltage_wakeup(4000));
+
+	std::thread harvester([](){
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		powertask_linux_notify_voltage(4100);
+	});
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	platform.sleep();
+	CHECK(elapsed_ms(&start) >= 90);
+
+	harvester.join();
+}
+
+/**
+ * @brief Linux port - run_forever waits for the harvester
+ * 
+ * The scope of this unit test is to validate the loop with the Linux port when
+ * the voltage is reported by another thread simulating the harvester.
+ * 
+ * It is expected the task to be executed once the harvester reports enough
+ * voltage.
+ */
+TEST(test_platform_linux, test_linux_run_forever_harvester){
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 1000);
+
+	fake_voltage = 1000;
+	iterations_left = 2;
+	platform.keep_running = fake_keep_running;
+	platform.idle_timeout = 5000;
+
+	std::thread harvester([](){
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		fake_voltage = 2000;
+		powertask_linux_notify_voltage(2000);
+	});
+
+	mock().expectOneCall("task1");
+
+	CHECK_EQUAL(0, powertask_run_forever(&scheduler, &energy_src, &platform));
+
+	harvester.join();
+
+	mock().checkExpectations();
+}
@@ -0,0 +1,9 @@
+#include <CppUTestExt/MockSupport.h>
+
+extern "C" {
+    #include <powertask/energy.h>
+
+    int powertask_get_available_energy(powertask_energy_source_t *energy_source){
+        return mock().actualCall("powertask_get_available_energy").returnIntValue();
+    }
+}
@@ -0,0 +1,155 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
+
+extern "C"
+{
+	#include <powertask/pool.h>
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_pool_regular){
+	powertask_energy_source_t supercap;
+	powertask_energy_source_t battery;
+	powertask_pool_source_t sources[2];
+	powertask_energy_pool_t pool;
+
+	void setup(){
+		supercap = (powertask_energy_source_t){0};
+		battery = (powertask_energy_source_t){0};
+
+		sources[0] = (powertask_pool_source_t){
+			.energy_source = &supercap,
+		};
+		sources[1] = (powertask_pool_source_t){
+			.energy_source = &battery,
+			.reserve_energy = 200,
+			.efficiency = 50,
+		};
+
+		pool = (powertask_energy_pool_t){
+			.sources = sources,
+			.number_of_sources = ARRAY_LENGTH(sources),
+			.policy = POWERTASK_POOL_PREFERRED,
+		};
+	}
+
+	void teardown(){
+		mock().clear();
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                         Unit Tests - test_pool_regular                                             */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Pool - Usable energy of a source
+ * 
+ * The scope of this unit test is to validate if the source energy model (reserve
+ * and conversion efficiency) is applied to the available energy.
+ * 
+ * It is expected the usable energy to be the available energy above the reserve,
+ * scaled by the efficiency, and never negative.
+ */
+TEST(test_pool_regular, test_pool_usable_energy){
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(1000);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(300);
+
+	CHECK_EQUAL(400, powertask_pool_get_usable_energy(&pool, 1));
+	CHECK_EQUAL(0, powertask_pool_get_usable_energy(&pool, 1));
+	CHECK_EQUAL(300, powertask_pool_get_usable_energy(&pool, 0));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Pool - Combined available energy
+ * 
+ * The scope of this unit test is to validate if the available energy of the
+ * pool is the sum of the usable energy of its sources.
+ * 
+ * It is expected the sum of both sources, after the energy model is applied.
+ */
+TEST(test_pool_regular, test_pool_available_energy){
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(300);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(1000);
+
+	CHECK_EQUAL(700, powertask_pool_get_available_energy(&pool));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Pool - Preferred policy
+ * 
+ * The scope of this unit test is to validate if the preferred source is used
+ * when it has enough energy, and another source otherwise.
+ * 
+ * It is expected the preferred source on the first selection and the other
+ * source on the second one.
+ */
+TEST(test_pool_regular, test_pool_select_preferred){
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(500);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(1000);
+
+	CHECK_EQUAL(0, powertask_pool_select(&pool, 0, 400));
+	CHECK_EQUAL(1, powertask_pool_select(&pool, 0, 300));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Pool - Strict and combined policies
+ * 
+ * The scope of this unit test is to validate if the strict policy never falls
+ * back to other sources, and if the combined policy admits against the sum of
+ * the sources.
+ * 
+ * It is expected the strict policy to fail and the combined policy to succeed
+ * with the same energy levels.
+ */
+TEST(test_pool_regular, test_pool_select_strict_and_combined){
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(300);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(300);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(1000);
+
+	pool.policy = POWERTASK_POOL_STRICT;
+	CHECK_EQUAL(-ENOENT, powertask_pool_select(&pool, 0, 500));
+
+	pool.policy = POWERTASK_POOL_COMBINED;
+	CHECK_EQUAL(0, powertask_pool_select(&pool, 0, 500));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Pool - Invalid parameters
+ * 
+ * The scope of this unit test is to validate the behaviour of the functions
+ * with an invalid pool or source.
+ * 
+ * It is expected to return an error code without reading any source.
+ */
+TEST(test_pool_regular, test_pool_invalid_parameters){
+	powertask_energy_pool_t empty_pool = {0};
+
+	mock().expectNoCall("powertask_get_available_energy");
+
+	CHECK(powertask_pool_get_usable_energy(NULL, 0) < 0);
+	CHECK(powertask_pool_get_usable_energy(&pool, 2) < 0);
+	CHECK(powertask_pool_get_available_energy(&empty_pool) < 0);
+	CHECK(powertask_pool_select(&empty_pool, 0, 0) < 0);
+
+	mock().checkExpectations();
+}
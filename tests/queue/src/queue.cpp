@@ -0,0 +1,198 @@
+#include <CppUTest/TestHarness.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+
+extern "C"
+{
+	#include <powertask/queue.h>
+}
+
+/** @brief Number of producer threads in the stress test */
+#define STRESS_PRODUCERS 4
+
+/** @brief Number of tasks pushed by each producer in the stress test */
+#define STRESS_TASKS_PER_PRODUCER 100000
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_queue_regular){
+	void setup(){
+
+	}
+
+	void teardown(){
+
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Internal variables - test_queue_regular                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Encodes a producer and a sequence number as a task pointer
+ * 
+ * The queue never dereferences the tasks, which allows the stress test to
+ * check ordering and uniqueness without allocating a task per push.
+ */
+static struct powertask_task_s *encode_task(uintptr_t producer, uintptr_t sequence){
+	return (struct powertask_task_s *)((producer << 24) | (sequence + 1));
+}
+
+/** @brief Queue shared by the stress test threads */
+static powertask_queue_t *stress_queue;
+
+/** @brief Number of producers that pushed all their tasks */
+static std::atomic<int> finished_producers;
+
+/** @brief Pushes all tasks of one producer, retrying while the queue is full */
+static void *producer_thread(void *arg){
+	uintptr_t producer = (uintptr_t)arg;
+
+	for(uintptr_t i = 0; i < STRESS_TASKS_PER_PRODUCER; i++){
+		while(powertask_queue_push(stress_queue, encode_task(producer, i)) == -ENOSPC){
+			sched_yield();
+		}
+	}
+
+	finished_producers++;
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                         Unit Tests - test_queue_regular                                            */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Queue - First in, first out
+ * 
+ * The scope of this unit test is to validate if tasks are popped in the order
+ * they were pushed, across wrap arounds of the slots.
+ * 
+ * It is expected the same order and an empty queue after all pops.
+ */
+TEST(test_queue_regular, test_queue_fifo){
+	POWERTASK_QUEUE_INIT(queue, 4);
+
+	for(uintptr_t round = 0; round < 3; round++){
+		for(uintptr_t i = 0; i < 3; i++){
+			CHECK_EQUAL(0, powertask_queue_push(&queue, encode_task(round, i)));
+		}
+		for(uintptr_t i = 0; i < 3; i++){
+			POINTERS_EQUAL(encode_task(round, i), powertask_queue_pop(&queue));
+		}
+	}
+
+	POINTERS_EQUAL(NULL, powertask_queue_pop(&queue));
+}
+
+/**
+ * @brief Queue - Full queue
+ * 
+ * The scope of this unit test is to validate if pushing into a full queue
+ * fails without overwriting queued tasks.
+ * 
+ * It is expected an error code and the queued tasks to be left untouched.
+ */
+TEST(test_queue_regular, test_queue_full){
+	POWERTASK_QUEUE_INIT(queue, 2);
+
+	CHECK_EQUAL(0, powertask_queue_push(&queue, encode_task(0, 0)));
+	CHECK_EQUAL(0, powertask_queue_push(&queue, encode_task(0, 1)));
+	CHECK_EQUAL(-ENOSPC, powertask_queue_push(&queue, encode_task(0, 2)));
+
+	POINTERS_EQUAL(encode_task(0, 0), powertask_queue_pop(&queue));
+	CHECK_EQUAL(0, powertask_queue_push(&queue, encode_task(0, 2)));
+	POINTERS_EQUAL(encode_task(0, 1), powertask_queue_pop(&queue));
+	POINTERS_EQUAL(encode_task(0, 2), powertask_queue_pop(&queue));
+}
+
+/**
+ * @brief Queue - Invalid parameters
+ * 
+ * The scope of this unit test is to validate the behaviour of the functions
+ * with a NULL or misconfigured queue.
+ * 
+ * It is expected push to return an error code and pop to return NULL.
+ */
+TEST(test_queue_regular, test_queue_invalid_parameters){
+	powertask_queue_slot_t slots[3] = {};
+	powertask_queue_t queue = {
+		.slots = slots,
+		.capacity = 3,
+	};
+
+	CHECK_EQUAL(-EINVAL, powertask_queue_push(NULL, encode_task(0, 0)));
+	CHECK_EQUAL(-EINVAL, powertask_queue_push(&queue, encode_task(0, 0)));
+	POINTERS_EQUAL(NULL, powertask_queue_pop(NULL));
+	POINTERS_EQUAL(NULL, powertask_queue_pop(&queue));
+}
+
+/**
+ * @brief Queue - Concurrent producers
+ * 
+ * The scope of this unit test is to validate if the queue is safe with several
+ * producer threads pushing while the consumer pops.
+ * 
+ * It is expected every task to be popped exactly once and the tasks of each
+ * producer to be popped in the order they were pushed.
+ */
+TEST(test_queue_regular, test_queue_stress_multiple_producers){
+	POWERTASK_QUEUE_INIT(queue, 64);
+	pthread_t producers[STRESS_PRODUCERS];
+	uintptr_t next_sequence[STRESS_PRODUCERS] = {0};
+	struct powertask_task_s *task;
+	long popped = 0;
+	bool in_order = true;
+
+	stress_queue = &queue;
+	finished_producers = 0;
+
+	for(uintptr_t i = 0; i < STRESS_PRODUCERS; i++){
+		CHECK_EQUAL(0, pthread_create(&producers[i], NULL, producer_thread, (void *)i));
+	}
+
+	/* Drain until the producers are done, whatever was popped, so that none stays blocked on a full queue. */
+	for(;;){
+		bool producers_done = finished_producers == STRESS_PRODUCERS;
+
+		task = powertask_queue_pop(&queue);
+
+		if(task == NULL){
+			if(producers_done){
+				break;
+			}
+			sched_yield();
+			continue;
+		}
+
+		uintptr_t producer = (uintptr_t)task >> 24;
+		uintptr_t sequence = ((uintptr_t)task & 0xFFFFFF) - 1;
+
+		popped++;
+
+		if(producer >= STRESS_PRODUCERS || sequence != next_sequence[producer]){
+			in_order = false;
+			continue;
+		}
+
+		next_sequence[producer]++;
+	}
+
+	for(int i = 0; i < STRESS_PRODUCERS; i++){
+		pthread_join(producers[i], NULL);
+	}
+
+	CHECK_EQUAL((long)STRESS_PRODUCERS * STRESS_TASKS_PER_PRODUCER, popped);
+	CHECK_TRUE(in_order);
+	POINTERS_EQUAL(NULL, powertask_queue_pop(&queue));
+}
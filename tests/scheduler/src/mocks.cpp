@@ -3,7 +3,7 @@
 #include <string.h>
 #include <errno.h>
 
-#define MAX_FAKE_STORAGE_LEN 1024
+#define MAX_FAKE_STORAGE_LEN 2048
 
 extern "C" {
     #include <powertask/energy.h>
@@ -17,7 +17,7 @@ extern "C" {
 
     int powertask_storage_save(void *data_to_store, size_t size_of_data){
 
-        if (data_to_store == NULL || size_of_data == 0) {
+        if (data_to_store == NULL || size_of_data == 0 || size_of_data > MAX_FAKE_STORAGE_LEN) {
             return -EINVAL;
         }
 
@@ -33,6 +33,10 @@ extern "C" {
             return -EINVAL;
         }
 
+        if (fake_storage_used > size_of_buffer){
+            return -ENOSPC;
+        }
+
         memcpy(buffer, fake_storage, fake_storage_used);
 
         return mock().actualCall("powertask_storage_load").returnIntValue();
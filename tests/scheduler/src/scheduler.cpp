@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <errno.h>
 
 #define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
 
@@ -43,6 +44,15 @@ bool condition_fails() {
 	return false;
 }
 
+/** @brief Number of calls to condition_counted() */
+static int condition_calls;
+
+/** @brief Successful condition, counting its calls */
+bool condition_counted() {
+	condition_calls++;
+	return true;
+}
+
 /** @brief Action of the 1st task */
 void task1(){
 	mock().actualCall("task1");
@@ -53,9 +63,33 @@ void task2(){
 	mock().actualCall("task2");
 }
 
+/** @brief Action of the 3rd task */
+void task3(){
+	mock().actualCall("task3");
+}
+
+/** @brief Radio power up */
+void radio_setup(){
+	mock().actualCall("radio_setup");
+}
+
+/** @brief Radio power down */
+void radio_teardown(){
+	mock().actualCall("radio_teardown");
+}
+
+/** @brief Supercapacitor routing */
+void supercap_select(){
+	mock().actualCall("supercap_select");
+}
+
 /** Tasks declaration */
 POWERTASK_DECLARE(task1);
 POWERTASK_DECLARE(task2);
+POWERTASK_DECLARE(task3);
+
+/** Resources declaration */
+POWERTASK_RESOURCE(radio, radio_setup, radio_teardown, 100);
 
 /* ------------------------------------------------------------------------------------------------------------------ */
 /*                                        Unit Tests - test_scheduler_regular                                         */
@@ -265,7 +299,7 @@ TEST(test_scheduler_regular, test_two_tasks_task2_depends_on_task1_and_task1_not
 	POWERTASK_TASK(scheduler, task1, task1, condition_fails, required_energy);
 	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_WAIT_FOR(task1), required_energy);
 
-	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
 	mock().expectNoCall("task1");
 	mock().expectNoCall("task2");
 	mock().ignoreOtherCalls();
@@ -364,6 +398,7 @@ TEST(test_scheduler_regular, test_schedular_current_state_is_stored){
 	/* Simulate system reset. Reset current state of the tasks. */
 	task_task1.complete = false;
 	task_task2.complete = false;
+	powertask_invalidate_state(&scheduler);
 
 	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
 
@@ -385,7 +420,7 @@ TEST(test_scheduler_regular, test_schedular_current_state_is_stored){
  * It is expected the current state of the scheduler to not be stored in memory.  
  */
 TEST(test_scheduler_regular, test_schedular_save_current_state_overflow){
-	const int load_current_state_max_number_of_tasks = 255;
+	const int load_current_state_max_number_of_tasks = POWERTASK_CONFIG_MAX_TASKS;
 
 	POWERTASK_INIT(scheduler, load_current_state_max_number_of_tasks+1);
 
@@ -519,4 +554,884 @@ TEST(test_scheduler_regular, test_loaded_current_state_length_mismatch)
 	powertask_run_scheduler(&scheduler, &energy_src);
 
 	CHECK(scheduler.number_of_tasks == 0);
-};
\ No newline at end of file
+};
+
+/**
+ * @brief Scheduler - Warm boot does not reload the stored state
+ * 
+ * The scope of this test is to validate if the scheduler only loads the stored
+ * state when the state in RAM was lost.
+ * 
+ * It is expected the storage to not be read on consecutive runs while powered,
+ * and to be read again after the state is invalidated.
+ */
+TEST(test_scheduler_regular, test_scheduler_warm_boot_skips_load)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task2, task2, condition_fails, required_energy);
+
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	/* Warm boot: RAM is still valid, so storage is not read. */
+	mock().expectNoCall("powertask_storage_load");
+	powertask_run_scheduler(&scheduler, &energy_src);
+	mock().checkExpectations();
+
+	/* Simulate system reset: the stored state is loaded again. */
+	mock().clear();
+	mock().expectOneCall("powertask_storage_load");
+	mock().ignoreOtherCalls();
+	powertask_invalidate_state(&scheduler);
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Tasks sharing a resource run in a single powered window
+ * 
+ * The scope of this test is to validate if the scheduler powers a resource up
+ * once for all the runnable tasks using it, and if the setup energy is only
+ * required by the task powering the resource up.
+ * 
+ * It is expected both tasks using the radio to run with a single radio setup
+ * and teardown, before the task which does not use it.
+ */
+TEST(test_scheduler_regular, test_scheduler_resource_window)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 3);
+
+	POWERTASK_TASK_WITH_RESOURCE(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy, radio);
+	POWERTASK_TASK(scheduler, task3, task3, condition_fails, required_energy);
+	POWERTASK_TASK_WITH_RESOURCE(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy, radio);
+
+	/* Radio setup energy is required for task1 but not for task2. */
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+101);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("radio_setup");
+	mock().expectOneCall("task1");
+	mock().expectOneCall("task2");
+	mock().expectOneCall("radio_teardown");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	CHECK_TRUE(task_task1.complete);
+	CHECK_TRUE(task_task2.complete);
+	CHECK_FALSE(resource_radio._powered);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Not enough energy to power a resource up
+ * 
+ * The scope of this test is to validate if the resource setup energy is taken
+ * into account when admitting the task that powers the resource up.
+ * 
+ * It is expected the resource and the task to not be powered up nor executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_resource_not_enough_setup_energy)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 1);
+
+	POWERTASK_TASK_WITH_RESOURCE(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy, radio);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+100);
+	mock().expectNoCall("radio_setup");
+	mock().expectNoCall("task1");
+	mock().expectNoCall("radio_teardown");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Task runs from another pool source
+ * 
+ * The scope of this test is to validate if the scheduler admits tasks against
+ * the pool source picked by the pool policy, and routes the supply to it.
+ * 
+ * It is expected the task to run from the supercapacitor when its preferred
+ * source (the battery) does not have enough energy.
+ */
+TEST(test_scheduler_regular, test_scheduler_pool_fallback_source)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK_WITH_SOURCE(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy, 1);
+
+	powertask_energy_source_t supercap = {0};
+	powertask_energy_source_t battery = {0};
+	powertask_pool_source_t sources[] = {
+		{ .energy_source = &supercap, .select = supercap_select },
+		{ .energy_source = &battery },
+	};
+	powertask_energy_pool_t pool = {
+		.sources = sources,
+		.number_of_sources = ARRAY_LENGTH(sources),
+		.policy = POWERTASK_POOL_PREFERRED,
+	};
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy-1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("supercap_select");
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler_pool(&scheduler, &pool));
+	CHECK(powertask_run_scheduler_pool(&scheduler, NULL) < 0);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Status queries
+ * 
+ * The scope of this test is to validate if the number of pending tasks and the
+ * cheapest pending task are kept up to date as tasks are added and executed.
+ * 
+ * It is expected the cheapest pending task to account for the resource setup
+ * energy, and to move to the next cheapest once it is executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_status_queries)
+{
+	POWERTASK_INIT(scheduler, 3);
+
+	POWERTASK_TASK(scheduler, task1, task1, condition_fails, 300);
+	POWERTASK_TASK_WITH_RESOURCE(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 100, radio);
+	POWERTASK_TASK(scheduler, task3, task3, POWERTASK_RUN_ALWAYS, 250);
+
+	CHECK_EQUAL(3, powertask_get_pending_tasks(&scheduler));
+	CHECK_EQUAL(&task_task2, powertask_get_cheapest_pending_task(&scheduler));
+	CHECK_EQUAL(200, powertask_get_cheapest_pending_energy(&scheduler));
+
+	/* Only the radio task can be afforded, and task3 is left as the cheapest pending task. */
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(201);
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	CHECK_EQUAL(2, powertask_get_pending_tasks(&scheduler));
+	CHECK_EQUAL(&task_task3, powertask_get_cheapest_pending_task(&scheduler));
+	CHECK_EQUAL(250, powertask_get_cheapest_pending_energy(&scheduler));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* task3 runs and task1 is left as the cheapest pending task. */
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(251);
+	mock().expectOneCall("task3");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	CHECK_EQUAL(1, powertask_get_pending_tasks(&scheduler));
+	CHECK_EQUAL(&task_task1, powertask_get_cheapest_pending_task(&scheduler));
+	CHECK_EQUAL(300, powertask_get_cheapest_pending_energy(&scheduler));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Status queries without cost index
+ * 
+ * The scope of this test is to validate the cheapest pending task of a
+ * scheduler not created with POWERTASK_INIT(), which has no cost index.
+ * 
+ * It is expected the cheapest pending task to be found by searching the tasks.
+ */
+TEST(test_scheduler_regular, test_scheduler_status_queries_without_index)
+{
+	powertask_task *list_of_tasks[2];
+	powertask_scheduler scheduler = {
+		.list_of_tasks = list_of_tasks,
+		._list_of_tasks_len = 2,
+	};
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+	POWERTASK_TASK(scheduler, task2, task2, condition_fails, 300);
+
+	CHECK_EQUAL(&task_task2, powertask_get_cheapest_pending_task(&scheduler));
+	CHECK_EQUAL(300, powertask_get_cheapest_pending_energy(&scheduler));
+
+	task_task2.complete = true;
+
+	CHECK_EQUAL(&task_task1, powertask_get_cheapest_pending_task(&scheduler));
+
+	task_task1.complete = true;
+
+	CHECK(powertask_get_cheapest_pending_task(&scheduler) == NULL);
+	CHECK_EQUAL(-ENOENT, powertask_get_cheapest_pending_energy(&scheduler));
+};
+
+/**
+ * @brief Scheduler - Status queries after a round is complete
+ * 
+ * The scope of this test is to validate if the aggregates are reset with the
+ * task states once all tasks are executed, and are invalid for NULL schedulers.
+ * 
+ * It is expected all tasks to be pending again.
+ */
+TEST(test_scheduler_regular, test_scheduler_status_queries_after_reset)
+{
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 300);
+
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(401);
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(2, powertask_run_scheduler(&scheduler, &energy_src));
+
+	CHECK_EQUAL(2, powertask_get_pending_tasks(&scheduler));
+	CHECK_EQUAL(&task_task2, powertask_get_cheapest_pending_task(&scheduler));
+
+	CHECK(powertask_get_pending_tasks(NULL) < 0);
+	CHECK(powertask_get_cheapest_pending_task(NULL) == NULL);
+	CHECK(powertask_get_cheapest_pending_energy(NULL) < 0);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Submitted tasks are activated on the next run
+ * 
+ * The scope of this test is to validate if tasks pushed through the submission
+ * queue are added to the scheduler, or become pending again if complete.
+ * 
+ * It is expected the submitted task to be added and executed, and to be
+ * executed again once resubmitted.
+ */
+TEST(test_scheduler_regular, test_scheduler_submitted_tasks_are_activated)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_QUEUE_INIT(submissions, 4);
+	scheduler.submissions = &submissions;
+
+	POWERTASK_TASK(scheduler, task1, task1, condition_fails, required_energy);
+	task_task2 = (powertask_task){
+		.action = task2,
+		.required_energy = required_energy,
+	};
+
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+	CHECK_EQUAL(1, scheduler.number_of_tasks);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(&task_task2, scheduler.list_of_tasks[1]);
+	CHECK_EQUAL(1, powertask_get_pending_tasks(&scheduler));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Resubmitting a complete task (twice) makes it pending once. */
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(2, scheduler.number_of_tasks);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Submitted task does not fit
+ * 
+ * The scope of this test is to validate the activation of a task that is not
+ * in a full scheduler.
+ * 
+ * It is expected the activation to be dropped and counted, and the following
+ * activations to still be applied.
+ */
+TEST(test_scheduler_regular, test_scheduler_submission_to_full_scheduler)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_QUEUE_INIT(submissions, 4);
+	scheduler.submissions = &submissions;
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	task_task2 = (powertask_task){
+		.action = task2,
+		.required_energy = required_energy,
+		.complete = true,
+	};
+
+	CHECK_EQUAL(-ENOSPC, powertask_add(&scheduler, &task_task2));
+
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task1));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(1, scheduler.number_of_tasks);
+	CHECK_EQUAL(1, powertask_get_dropped_submissions(&scheduler));
+	CHECK_EQUAL(true, task_task2.complete);
+	CHECK(powertask_queue_pop(&submissions) == NULL);
+
+	CHECK(powertask_get_dropped_submissions(NULL) < 0);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Submission of a task with a duplicate id
+ * 
+ * The scope of this test is to validate if an activation rejected for a reason
+ * other than a full scheduler leaves the task and the dropped count unchanged.
+ * 
+ * It is expected the task to not be added nor counted as dropped.
+ */
+TEST(test_scheduler_regular, test_scheduler_submission_with_duplicate_id)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_QUEUE_INIT(submissions, 4);
+	scheduler.submissions = &submissions;
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	task_task2 = (powertask_task){
+		.action = task2,
+		.required_energy = required_energy,
+		.complete = true,
+		.id = task_task1.id,
+	};
+
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("task1");
+	mock().expectNoCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(1, scheduler.number_of_tasks);
+	CHECK_EQUAL(0, powertask_get_dropped_submissions(&scheduler));
+	CHECK_EQUAL(true, task_task2.complete);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Submit without a submission queue
+ * 
+ * The scope of this test is to validate if submitting a task fails when the
+ * scheduler has no submission queue.
+ * 
+ * It is expected to return an error code.
+ */
+TEST(test_scheduler_regular, test_scheduler_submit_without_queue)
+{
+	POWERTASK_INIT(scheduler, 1);
+
+	CHECK(powertask_submit(&scheduler, &task_task1) < 0);
+	CHECK(powertask_submit(NULL, &task_task1) < 0);
+};
+
+/**
+ * @brief Scheduler - Stored state survives a firmware update
+ * 
+ * The scope of this test is to validate if the stored task states are matched
+ * with the tasks by their identifier rather than by their position, so that
+ * adding and reordering tasks keeps the progress of the unchanged ones.
+ * 
+ * It is expected task1 to not be executed again after the update, and the
+ * other tasks to be executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_stored_state_matched_by_id)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy-1);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate a firmware update: task3 is added and the tasks are reordered. */
+	POWERTASK_INIT(updated_scheduler, 3);
+
+	POWERTASK_TASK(updated_scheduler, task3, task3, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(updated_scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(updated_scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+
+	CHECK(task_task1.id != task_task2.id);
+	CHECK_EQUAL(powertask_task_id("task1"), task_task1.id);
+
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().expectOneCall("task3");
+	mock().ignoreOtherCalls();
+
+	powertask_run_scheduler(&updated_scheduler, &energy_src);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Tasks with duplicate ids
+ * 
+ * The scope of this test is to validate if the scheduler rejects a task whose
+ * id is already used, as both would restore the same stored state. Tasks set
+ * up without the task macros have id 0, which is no id.
+ * 
+ * It is expected only the first task with each non-zero id to be added, and
+ * every task without an id to be added.
+ */
+TEST(test_scheduler_regular, test_scheduler_duplicate_task_id)
+{
+	POWERTASK_INIT(scheduler, 4);
+
+	powertask_task manual_task1 = {
+		.action = task1,
+		.condition = POWERTASK_RUN_ALWAYS,
+		.required_energy = 400
+	};
+	powertask_task manual_task2 = manual_task1;
+
+	CHECK_EQUAL(0, powertask_add(&scheduler, &manual_task1));
+	CHECK_EQUAL(0, powertask_add(&scheduler, &manual_task2));
+
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 400);
+	CHECK_EQUAL(-EEXIST, powertask_add(&scheduler, &task_task2));
+
+	CHECK_EQUAL(3, scheduler.number_of_tasks);
+}
+
+/**
+ * @brief Scheduler - Stored state survives removing a task
+ * 
+ * The scope of this test is to validate if a state stored with more tasks than
+ * the scheduler now holds is still restored, dropping the removed tasks.
+ * 
+ * It is expected task1 to not be executed again after the update.
+ */
+TEST(test_scheduler_regular, test_scheduler_stored_state_after_task_removal)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 3);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task3, task3, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy-1);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate a firmware update removing task3. */
+	POWERTASK_INIT(updated_scheduler, 2);
+
+	POWERTASK_TASK(updated_scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(updated_scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_run_scheduler(&updated_scheduler, &energy_src);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Stored state survives renaming a task
+ * 
+ * The scope of this test is to validate if a task declared with an explicit id
+ * restores the state stored under its previous name.
+ * 
+ * It is expected the renamed task to not be executed again.
+ */
+TEST(test_scheduler_regular, test_scheduler_task_with_id_keeps_stored_state)
+{
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy-1);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	powertask_run_scheduler(&scheduler, &energy_src);
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate a firmware update renaming task1 to task3. */
+	POWERTASK_INIT(updated_scheduler, 2);
+
+	POWERTASK_TASK_WITH_ID(updated_scheduler, task3, powertask_task_id("task1"), task3, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(updated_scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectNoCall("task3");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_run_scheduler(&updated_scheduler, &energy_src);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Task reserving energy holds back cheaper tasks
+ * 
+ * The scope of this test is to validate if a pending task with reserved energy
+ * prevents the other tasks from using that energy.
+ * 
+ * It is expected the cheaper task to only be executed after the reserving task.
+ */
+TEST(test_scheduler_regular, test_scheduler_reserved_energy)
+{
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 50);
+	POWERTASK_TASK_WITH_RESERVATION(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 300, 300);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectNoCall("task1");
+	mock().expectNoCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Enough for the reserving task, but not for both. */
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(301);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(51);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Task reserving energy waiting for its condition
+ * 
+ * The scope of this test is to validate if a reserving task whose condition
+ * does not hold leaves the energy to the other tasks.
+ * 
+ * It is expected the cheaper task to be executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_reserved_energy_condition_fails)
+{
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 50);
+	POWERTASK_TASK_WITH_RESERVATION(scheduler, task2, task2, condition_fails, 300, 300);
+
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(100);
+	mock().expectOneCall("task1");
+	mock().expectNoCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Aged task reserves its energy
+ * 
+ * The scope of this test is to validate if a task skipped for lack of energy
+ * for aging_threshold runs holds back cheap tasks that keep being submitted.
+ * 
+ * It is expected the resubmitted cheap task to only be executed once there is
+ * enough energy for the aged task.
+ */
+TEST(test_scheduler_regular, test_scheduler_aged_task_reserves_energy)
+{
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_QUEUE_INIT(submissions, 4);
+	scheduler.submissions = &submissions;
+	scheduler.aging_threshold = 1;
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 300);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 50);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectNoCall("task1");
+	mock().expectNoCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* The reservation is released once the aged task is executed. */
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(301);
+	mock().expectOneCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(2, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Held back tasks take over the reservation
+ * 
+ * The scope of this test is to validate if a task that cannot be executed does
+ * not hold back the other tasks forever.
+ * 
+ * It is expected the cheap task to take over the reservation, and be executed,
+ * once it waited longer than the task holding the reservation.
+ */
+TEST(test_scheduler_regular, test_scheduler_reservation_is_taken_over)
+{
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_QUEUE_INIT(submissions, 4);
+	scheduler.submissions = &submissions;
+	scheduler.aging_threshold = 1;
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 1000);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 50);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	CHECK_EQUAL(0, powertask_submit(&scheduler, &task_task2));
+
+	mock().expectNCalls(2, "powertask_get_available_energy").andReturnValue(100);
+	mock().expectNoCall("task1");
+	mock().expectNoCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Condition of the task holding the reservation
+ * 
+ * The scope of this test is to validate if the condition of the task holding
+ * the reservation is only called when the reservation is made.
+ * 
+ * It is expected the condition to be called once, and the task to be executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_reserving_condition_called_once)
+{
+	POWERTASK_INIT(scheduler, 1);
+
+	POWERTASK_TASK_WITH_RESERVATION(scheduler, task1, task1, condition_counted, 300, 300);
+	condition_calls = 0;
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(301);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(1, condition_calls);
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Cheapest pending energy with a reservation
+ * 
+ * The scope of this test is to validate if the energy needed by the next run
+ * accounts for the reservation made by the last run.
+ * 
+ * It is expected the energy to be the lowest of the energy of the holder and
+ * of the cheapest other task plus the reserved energy, and to drop to the
+ * cheapest task once the holder is executed.
+ */
+TEST(test_scheduler_regular, test_scheduler_cheapest_pending_energy_with_reservation)
+{
+	POWERTASK_INIT(scheduler, 2);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 50);
+	POWERTASK_TASK_WITH_RESERVATION(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 300, 300);
+
+	CHECK_EQUAL(50, powertask_get_cheapest_pending_energy(&scheduler));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	/* task1 needs 50 + 300, more than task2 itself. */
+	CHECK_EQUAL(300, powertask_get_cheapest_pending_energy(&scheduler));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(301);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+	CHECK_EQUAL(50, powertask_get_cheapest_pending_energy(&scheduler));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* A reservation below the energy of the holder. */
+	fake_clear_powertask_storage();
+	POWERTASK_INIT(small_reservation_scheduler, 2);
+
+	POWERTASK_TASK(small_reservation_scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 50);
+	POWERTASK_TASK_WITH_RESERVATION(small_reservation_scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 300, 100);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&small_reservation_scheduler, &energy_src));
+	CHECK_EQUAL(150, powertask_get_cheapest_pending_energy(&small_reservation_scheduler));
+
+	mock().checkExpectations();
+};
+
+/**
+ * @brief Scheduler - Energy is sampled once per pass
+ * 
+ * The scope of this test is to validate if the available energy is only read
+ * again after an action spent energy, rather than once per task.
+ * 
+ * It is expected a single read when every task is skipped, and a second read
+ * after the executed task, for the task following it.
+ */
+TEST(test_scheduler_regular, test_scheduler_energy_sampled_once_per_pass)
+{
+	POWERTASK_INIT(scheduler, 3);
+
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 100);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, 300);
+	POWERTASK_TASK(scheduler, task3, task3, POWERTASK_RUN_ALWAYS, 200);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(50);
+	mock().ignoreOtherCalls();
+
+	powertask_energy_source_t energy_src = {0};
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(250);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(150);
+	mock().expectOneCall("task1");
+	mock().expectNoCall("task2");
+	mock().expectNoCall("task3");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+};
@@ -0,0 +1,216 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+#include <stdio.h>
+#include <stdbool.h>
+
+extern "C"
+{
+	#include <powertask/scheduler.h>
+	#include <powertask/energy.h>
+
+	#include "fake.h"
+}
+
+/** @brief Bits of the task id kept by the task bit-field */
+#define TASK_ID_MASK 0x7FFFFFFFU
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_scheduler_minimal){
+	void setup(){
+
+	}
+
+	void teardown(){
+		mock().clear();
+		fake_clear_powertask_storage();
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                    Internal variables - test_scheduler_minimal                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Action of the 1st task */
+void task1(){
+	mock().actualCall("task1");
+}
+
+/** @brief Action of the 2nd task */
+void task2(){
+	mock().actualCall("task2");
+}
+
+/** Tasks declaration */
+POWERTASK_DECLARE(task1);
+POWERTASK_DECLARE(task2);
+
+/** @brief Energy source (the available energy is mocked) */
+static powertask_energy_source_t energy_src = {0};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Unit Tests - test_scheduler_minimal                                         */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Minimal profile - Task setup
+ *
+ * The scope of this unit test is to validate the task layout of the minimal
+ * profile: narrow counters and energies, the description in a const table and
+ * the completion flag sharing a word with the id.
+ *
+ * It is expected the description to be reachable through the task, and
+ * setting the completion flag to leave the id unchanged.
+ */
+TEST(test_scheduler_minimal, test_scheduler_minimal_task_setup){
+	const uint32_t task1_id = powertask_task_id("task1") & TASK_ID_MASK;
+
+	CHECK_EQUAL(1, sizeof(powertask_count_t));
+	CHECK_EQUAL(2, sizeof(powertask_energy_t));
+
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+
+	CHECK_EQUAL(1, scheduler.number_of_tasks);
+	CHECK_EQUAL(task1, POWERTASK_TASK_INFO(&task_task1)->action);
+	CHECK_EQUAL(POWERTASK_RUN_ALWAYS, POWERTASK_TASK_INFO(&task_task1)->condition);
+	CHECK_EQUAL(400, POWERTASK_TASK_INFO(&task_task1)->required_energy);
+	CHECK_EQUAL(task1_id, task_task1.id);
+	CHECK_EQUAL(0, task_task1.complete);
+
+	task_task1.complete = true;
+
+	CHECK_EQUAL(task1_id, task_task1.id);
+	CHECK_EQUAL(1, task_task1.complete);
+}
+
+/**
+ * @brief Minimal profile - Stored state is restored
+ *
+ * The scope of this unit test is to validate if the state stored from the
+ * buffer of the scheduler restores the completion flags after a reset.
+ *
+ * It is expected the task completed before the reset to not be executed again.
+ */
+TEST(test_scheduler_minimal, test_scheduler_minimal_state_is_restored){
+	const int required_energy = 400;
+
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, required_energy);
+	POWERTASK_TASK(scheduler, task2, task2, POWERTASK_RUN_ALWAYS, required_energy);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy-1);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate system reset. Reset current state of the tasks. */
+	task_task1.complete = false;
+	task_task2.complete = false;
+	powertask_invalidate_state(&scheduler);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(required_energy+1);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Minimal profile - Scheduler without its own state buffer
+ *
+ * The scope of this unit test is to validate if a scheduler set up without
+ * POWERTASK_INIT() stores its state through the static fallback buffer.
+ *
+ * It is expected the task completed before the reset to not be executed again.
+ */
+TEST(test_scheduler_minimal, test_scheduler_minimal_fallback_state_buffer){
+	static const powertask_task_info task1_info = {
+		.action = task1,
+		.condition = POWERTASK_RUN_ALWAYS,
+		.required_energy = 400
+	};
+	static const powertask_task_info task2_info = {
+		.action = task2,
+		.condition = POWERTASK_RUN_ALWAYS,
+		.required_energy = 400
+	};
+	static powertask_task tasks[2];
+	static powertask_task *list_of_tasks[2];
+	static powertask_count_t tasks_by_cost[2];
+	static powertask_scheduler scheduler;
+
+	tasks[0] = (powertask_task){ .info = &task1_info, .id = 1 };
+	tasks[1] = (powertask_task){ .info = &task2_info, .id = 2 };
+	scheduler = (powertask_scheduler){
+		.list_of_tasks = list_of_tasks,
+		._list_of_tasks_len = 2,
+		._tasks_by_cost = tasks_by_cost,
+	};
+
+	CHECK_EQUAL(0, powertask_add(&scheduler, &tasks[0]));
+	CHECK_EQUAL(0, powertask_add(&scheduler, &tasks[1]));
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(401);
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(399);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Simulate system reset. Reset current state of the tasks. */
+	tasks[0].complete = false;
+	tasks[1].complete = false;
+	powertask_invalidate_state(&scheduler);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(401);
+	mock().expectNoCall("task1");
+	mock().expectOneCall("task2");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+}
+
+/**
+ * @brief Minimal profile - Task age saturates
+ *
+ * The scope of this unit test is to validate if the age of a task skipped for
+ * lack of energy does not wrap around its 8-bit counter.
+ *
+ * It is expected the age to stop at 255 and the task to stay pending.
+ */
+TEST(test_scheduler_minimal, test_scheduler_minimal_age_saturates){
+	const int runs = 300;
+
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+
+	mock().expectNCalls(runs, "powertask_get_available_energy").andReturnValue(0);
+	mock().expectNoCall("task1");
+	mock().ignoreOtherCalls();
+
+	for(int i = 0; i < runs; i++){
+		CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+	}
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(255, task_task1._age);
+	CHECK_EQUAL(1, powertask_get_pending_tasks(&scheduler));
+}
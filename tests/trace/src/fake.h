@@ -0,0 +1,17 @@
+/**
+ * @brief Clear fake trace storage
+ * 
+ * @details Allows to erase the fake trace region used in the unit tests.
+ */
+void fake_clear_trace_storage(void);
+
+/**
+ * @brief Get fake trace storage
+ * 
+ * @details Allows to decode the fake trace region used in the unit tests.
+ * 
+ * @param[out] size Size of the fake trace region.
+ * 
+ * @return Fake trace region.
+ */
+const void *fake_trace_storage(size_t *size);
@@ -0,0 +1,42 @@
+#include <CppUTestExt/MockSupport.h>
+
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define MAX_FAKE_TRACE_STORAGE_LEN 44
+
+extern "C" {
+    static uint8_t fake_trace_region[MAX_FAKE_TRACE_STORAGE_LEN];
+
+    int powertask_storage_trace_write(size_t offset, const void *data_to_store, size_t size_of_data){
+
+        if (data_to_store == NULL || offset + size_of_data > MAX_FAKE_TRACE_STORAGE_LEN) {
+            return -EINVAL;
+        }
+
+        memcpy(&fake_trace_region[offset], data_to_store, size_of_data);
+
+        return mock().actualCall("powertask_storage_trace_write").returnIntValue();
+    }
+
+    int powertask_storage_trace_read(size_t offset, void *buffer, size_t size_of_buffer){
+
+        if (buffer == NULL || offset + size_of_buffer > MAX_FAKE_TRACE_STORAGE_LEN) {
+            return -EINVAL;
+        }
+
+        memcpy(buffer, &fake_trace_region[offset], size_of_buffer);
+
+        return mock().actualCall("powertask_storage_trace_read").returnIntValue();
+    }
+
+    void fake_clear_trace_storage(void){
+        memset(fake_trace_region, 0, MAX_FAKE_TRACE_STORAGE_LEN);
+    }
+
+    const void *fake_trace_storage(size_t *size){
+        *size = MAX_FAKE_TRACE_STORAGE_LEN;
+        return fake_trace_region;
+    }
+}
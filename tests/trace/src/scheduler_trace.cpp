@@ -0,0 +1,179 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+#include <stdio.h>
+#include <stdbool.h>
+
+extern "C"
+{
+	#include <powertask/scheduler.h>
+	#include <powertask/trace.h>
+
+	#include "fake.h"
+	#include "../../scheduler/src/fake.h"
+}
+
+/** @brief Number of records in the fake trace region */
+#define TRACE_CAPACITY 4
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_scheduler_trace){
+	void setup(){
+
+	}
+
+	void teardown(){
+		mock().clear();
+		fake_clear_trace_storage();
+		fake_clear_powertask_storage();
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                       Internal variables - test_scheduler_trace                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Records decoded from the fake trace region */
+static powertask_trace_record_t decoded[TRACE_CAPACITY];
+
+/** @brief Number of records decoded from the fake trace region */
+static int number_of_decoded;
+
+/** @brief Copies each decoded record */
+static int decode_record(const powertask_trace_record_t *record, void *ctx){
+	decoded[number_of_decoded++] = *record;
+	return 0;
+}
+
+/** @brief Decodes the fake trace region */
+static int decode_fake_trace(void){
+	size_t size;
+	const void *region = fake_trace_storage(&size);
+
+	number_of_decoded = 0;
+	return powertask_trace_decode(region, size, decode_record, NULL);
+}
+
+/** @brief Energy source (the available energy is mocked) */
+static powertask_energy_source_t energy_src = {
+	.capacitance = 1,
+};
+
+/** @brief Failing condition */
+bool condition_fails() {
+	return false;
+}
+
+/** @brief Action of the 1st task */
+void task1(){
+	mock().actualCall("task1");
+}
+
+/** @brief Action of the 2nd task */
+void task2(){
+	mock().actualCall("task2");
+}
+
+/** Tasks declaration */
+POWERTASK_DECLARE(task1);
+POWERTASK_DECLARE(task2);
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Unit Tests - test_scheduler_trace                                           */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Scheduler trace - Executed task
+ *
+ * The scope of this unit test is to validate the records of a pass executing a
+ * task, after the scheduler state was lost.
+ *
+ * It is expected the reset, the admission and completion of the task, named by
+ * its stable id, and the checkpoint to be written on that checkpoint.
+ */
+TEST(test_scheduler_trace, test_scheduler_trace_executed_task){
+	const uint32_t task1_id = POWERTASK_TRACE_TASK_ID(powertask_task_id("task1"));
+
+	POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 100);
+	POWERTASK_INIT(scheduler, 1);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+	scheduler.trace = &trace;
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(1000);
+	mock().expectOneCall("task1");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(1, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(4, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_RESET, decoded[0].event);
+	CHECK_EQUAL(POWERTASK_TRACE_NO_TASK, decoded[0].task);
+	CHECK_EQUAL(POWERTASK_TRACE_ADMITTED, decoded[1].event);
+	CHECK_EQUAL(task1_id, decoded[1].task);
+	CHECK_EQUAL(POWERTASK_TRACE_COMPLETED, decoded[2].event);
+	CHECK_EQUAL(task1_id, decoded[2].task);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[3].event);
+}
+
+/**
+ * @brief Scheduler trace - Skipped tasks
+ *
+ * The scope of this unit test is to validate the records of passes skipping a
+ * task for lack of energy and another because its condition fails.
+ *
+ * It is expected each skip to name its task, in the order of the pass. The
+ * first pass is written on its checkpoint, as it holds the reset. The next one
+ * only holds skips, so it waits for the flush interval, and the one after it
+ * repeats it, so it is only counted.
+ */
+TEST(test_scheduler_trace, test_scheduler_trace_skipped_tasks){
+	POWERTASK_TRACE_INIT(trace, 8, TRACE_CAPACITY, 2);
+	POWERTASK_INIT(scheduler, 2);
+	POWERTASK_TASK(scheduler, task1, task1, POWERTASK_RUN_ALWAYS, 400);
+	POWERTASK_TASK(scheduler, task2, task2, condition_fails, 50);
+	scheduler.trace = &trace;
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	CHECK_EQUAL(4, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_RESET, decoded[0].event);
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_ENERGY, decoded[1].event);
+	CHECK_EQUAL(POWERTASK_TRACE_TASK_ID(powertask_task_id("task1")), decoded[1].task);
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_CONDITION, decoded[2].event);
+	CHECK_EQUAL(POWERTASK_TRACE_TASK_ID(powertask_task_id("task2")), decoded[2].task);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[3].event);
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().expectNoCall("powertask_storage_trace_write");
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+	mock().clear();
+
+	mock().expectOneCall("powertask_get_available_energy").andReturnValue(100);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_run_scheduler(&scheduler, &energy_src));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(4, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_ENERGY, decoded[0].event);
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_CONDITION, decoded[1].event);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[2].event);
+	CHECK_EQUAL(POWERTASK_TRACE_REPEATED, decoded[3].event);
+	CHECK_EQUAL(1, decoded[3].count);
+}
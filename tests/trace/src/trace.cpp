@@ -0,0 +1,354 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C"
+{
+	#include <powertask/trace.h>
+
+	#include "fake.h"
+}
+
+/** @brief Number of records in the fake trace region */
+#define TRACE_CAPACITY 4
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                               Test groups declaration                                              */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+TEST_GROUP(test_trace_regular){
+	void setup(){
+
+	}
+
+	void teardown(){
+		mock().clear();
+		fake_clear_trace_storage();
+	}
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                        Internal variables - test_trace_regular                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Records decoded from the fake trace region */
+static powertask_trace_record_t decoded[TRACE_CAPACITY];
+
+/** @brief Number of records decoded from the fake trace region */
+static int number_of_decoded;
+
+/** @brief Copies each decoded record */
+int decode_record(const powertask_trace_record_t *record, void *ctx){
+	decoded[number_of_decoded++] = *record;
+	return 0;
+}
+
+/** @brief Decodes the fake trace region */
+static int decode_fake_trace(void){
+	size_t size;
+	const void *region = fake_trace_storage(&size);
+
+	number_of_decoded = 0;
+	return powertask_trace_decode(region, size, decode_record, NULL);
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                         Unit Tests - test_trace_regular                                            */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/**
+ * @brief Trace - Region size
+ * 
+ * The scope of this unit test is to validate if the fake trace region matches
+ * the size required by the trace capacity used in the tests.
+ * 
+ * It is expected the region size to be the header followed by the records.
+ */
+TEST(test_trace_regular, test_trace_region_size){
+	size_t size;
+
+	fake_trace_storage(&size);
+
+	CHECK_EQUAL(POWERTASK_TRACE_REGION_SIZE(TRACE_CAPACITY), size);
+}
+
+/**
+ * @brief Trace - Skipped events are rate limited
+ * 
+ * The scope of this unit test is to validate if passes repeating the skips of
+ * the previous pass are merged into a single record, and if batches holding
+ * only skipped events are written once every flush interval checkpoints.
+ * 
+ * It is expected no writes on the first checkpoints, and the batch written on
+ * the last one to hold the first pass and a record counting the repeated ones.
+ */
+TEST(test_trace_regular, test_trace_skips_are_rate_limited){
+	const int passes = 3;
+
+	POWERTASK_TRACE_INIT(trace, 8, TRACE_CAPACITY, passes);
+
+	mock().expectNoCall("powertask_storage_trace_write");
+	mock().ignoreOtherCalls();
+
+	for(int i = 0; i < passes - 1; i++){
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_CONDITION, 1));
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK));
+	}
+
+	mock().checkExpectations();
+	mock().clear();
+
+	/* Records and header. */
+	mock().expectNCalls(2, "powertask_storage_trace_write").andReturnValue(0);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_CONDITION, 1));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(4, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_ENERGY, decoded[0].event);
+	CHECK_EQUAL(1, decoded[0].count);
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_CONDITION, decoded[1].event);
+	CHECK_EQUAL(1, decoded[1].count);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[2].event);
+	CHECK_EQUAL(1, decoded[2].count);
+	CHECK_EQUAL(POWERTASK_TRACE_REPEATED, decoded[3].event);
+	CHECK_EQUAL(passes - 1, decoded[3].count);
+}
+
+/**
+ * @brief Trace - Passes differing from the previous one are kept
+ * 
+ * The scope of this unit test is to validate if a pass skipping other tasks
+ * than the previous pass is not merged into it.
+ * 
+ * It is expected each pass to be decoded with its own records.
+ */
+TEST(test_trace_regular, test_trace_different_passes_are_kept){
+	POWERTASK_TRACE_INIT(trace, 8, TRACE_CAPACITY, 100);
+
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 1));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK));
+	CHECK_EQUAL(0, powertask_trace_flush(&trace));
+
+	CHECK_EQUAL(4, decode_fake_trace());
+	CHECK_EQUAL(0, decoded[0].task);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[1].event);
+	CHECK_EQUAL(1, decoded[2].task);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[3].event);
+}
+
+/**
+ * @brief Trace - Repeated events are coalesced
+ * 
+ * The scope of this unit test is to validate if an event repeating the
+ * previous record is merged into it, and only into it.
+ * 
+ * It is expected the decoded timeline to keep the order of the events.
+ */
+TEST(test_trace_regular, test_trace_repeats_are_coalesced_in_order){
+	POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 100);
+
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 1));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_flush(&trace));
+
+	CHECK_EQUAL(3, decode_fake_trace());
+	CHECK_EQUAL(0, decoded[0].task);
+	CHECK_EQUAL(2, decoded[0].count);
+	CHECK_EQUAL(1, decoded[1].task);
+	CHECK_EQUAL(1, decoded[1].count);
+	CHECK_EQUAL(0, decoded[2].task);
+	CHECK_EQUAL(1, decoded[2].count);
+}
+
+/**
+ * @brief Trace - Completed tasks are written on the next checkpoint
+ * 
+ * The scope of this unit test is to validate if batches holding events other
+ * than skips are written on the next checkpoint.
+ * 
+ * It is expected the batch to be written and to decode into the recorded
+ * events.
+ */
+TEST(test_trace_regular, test_trace_urgent_events_are_written_on_checkpoint){
+	POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 100);
+
+	mock().expectNCalls(2, "powertask_storage_trace_write").andReturnValue(0);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_RESET, POWERTASK_TRACE_NO_TASK));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_COMPLETED, 1));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_CHECKPOINT, POWERTASK_TRACE_NO_TASK));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(3, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_RESET, decoded[0].event);
+	CHECK_EQUAL(POWERTASK_TRACE_COMPLETED, decoded[1].event);
+	CHECK_EQUAL(1, decoded[1].task);
+	CHECK_EQUAL(POWERTASK_TRACE_CHECKPOINT, decoded[2].event);
+	CHECK_EQUAL(POWERTASK_TRACE_NO_TASK, decoded[2].task);
+}
+
+/**
+ * @brief Trace - Admissions are written right away
+ * 
+ * The scope of this unit test is to validate if the admission of a task is
+ * written before its action runs, so that it survives a power failure during
+ * the action.
+ * 
+ * It is expected the batch to be written when the admission is recorded.
+ */
+TEST(test_trace_regular, test_trace_admission_is_written_right_away){
+	POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 100);
+
+	mock().expectNCalls(2, "powertask_storage_trace_write").andReturnValue(0);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_ENERGY, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_ADMITTED, 1));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(2, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_SKIPPED_ENERGY, decoded[0].event);
+	CHECK_EQUAL(POWERTASK_TRACE_ADMITTED, decoded[1].event);
+	CHECK_EQUAL(1, decoded[1].task);
+}
+
+/**
+ * @brief Trace - Ring wraps around
+ * 
+ * The scope of this unit test is to validate if the ring keeps the newest
+ * records when more records than its capacity are written, across a reset.
+ * 
+ * It is expected the decoded records to be the newest ones, from the oldest
+ * to the newest.
+ */
+TEST(test_trace_regular, test_trace_ring_wraps_across_reset){
+	mock().ignoreOtherCalls();
+
+	{
+		POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 1);
+
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_RESET, POWERTASK_TRACE_NO_TASK));
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_COMPLETED, 0));
+		CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_COMPLETED, 1));
+		CHECK_EQUAL(0, powertask_trace_flush(&trace));
+	}
+
+	/* Simulate system reset: a new trace instance resumes from storage. */
+	{
+		POWERTASK_TRACE_INIT(trace_after_reset, 4, TRACE_CAPACITY, 1);
+
+		CHECK_EQUAL(0, powertask_trace_record(&trace_after_reset, POWERTASK_TRACE_RESET, POWERTASK_TRACE_NO_TASK));
+		CHECK_EQUAL(0, powertask_trace_record(&trace_after_reset, POWERTASK_TRACE_COMPLETED, 2));
+		CHECK_EQUAL(0, powertask_trace_flush(&trace_after_reset));
+	}
+
+	CHECK_EQUAL(TRACE_CAPACITY, decode_fake_trace());
+	CHECK_EQUAL(POWERTASK_TRACE_COMPLETED, decoded[0].event);
+	CHECK_EQUAL(0, decoded[0].task);
+	CHECK_EQUAL(POWERTASK_TRACE_COMPLETED, decoded[1].event);
+	CHECK_EQUAL(1, decoded[1].task);
+	CHECK_EQUAL(POWERTASK_TRACE_RESET, decoded[2].event);
+	CHECK_EQUAL(POWERTASK_TRACE_COMPLETED, decoded[3].event);
+	CHECK_EQUAL(2, decoded[3].task);
+}
+
+/**
+ * @brief Trace - Padded dump
+ * 
+ * The scope of this unit test is to validate if a dump larger than the trace
+ * region, e.g. a whole erased flash page, is decoded with the capacity stored
+ * in the header, and if a dump smaller than the region is rejected.
+ * 
+ * It is expected the padded dump to decode into the recorded events, in order.
+ */
+TEST(test_trace_regular, test_trace_decode_padded_dump){
+	size_t size;
+	const void *region = fake_trace_storage(&size);
+	uint8_t dump[POWERTASK_TRACE_REGION_SIZE(TRACE_CAPACITY) + 64];
+
+	mock().ignoreOtherCalls();
+
+	{
+		POWERTASK_TRACE_INIT(trace, 4, TRACE_CAPACITY, 1);
+
+		for(int i = 0; i < TRACE_CAPACITY + 2; i++){
+			CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_COMPLETED, i));
+			CHECK_EQUAL(0, powertask_trace_flush(&trace));
+		}
+	}
+
+	memset(dump, 0xFF, sizeof(dump));
+	memcpy(dump, region, size);
+
+	number_of_decoded = 0;
+	CHECK_EQUAL(TRACE_CAPACITY, powertask_trace_decode(dump, sizeof(dump), decode_record, NULL));
+	for(int i = 0; i < TRACE_CAPACITY; i++){
+		CHECK_EQUAL(i + 2, decoded[i].task);
+	}
+
+	CHECK(powertask_trace_decode(dump, size - 1, decode_record, NULL) < 0);
+}
+
+/**
+ * @brief Trace - Full batch
+ * 
+ * The scope of this unit test is to validate if a full batch is written before
+ * a new record is added.
+ * 
+ * It is expected the batch to be written when the second record is added.
+ */
+TEST(test_trace_regular, test_trace_full_batch_is_written){
+	POWERTASK_TRACE_INIT(trace, 1, TRACE_CAPACITY, 100);
+
+	mock().expectNCalls(2, "powertask_storage_trace_write").andReturnValue(0);
+	mock().ignoreOtherCalls();
+
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_CONDITION, 0));
+	CHECK_EQUAL(0, powertask_trace_record(&trace, POWERTASK_TRACE_SKIPPED_CONDITION, 1));
+
+	mock().checkExpectations();
+
+	CHECK_EQUAL(1, decode_fake_trace());
+	CHECK_EQUAL(0, decoded[0].task);
+}
+
+/**
+ * @brief Trace - Invalid parameters
+ * 
+ * The scope of this unit test is to validate the behaviour of the functions
+ * with invalid parameters or an uninitialized region.
+ * 
+ * It is expected to return an error code.
+ */
+TEST(test_trace_regular, test_trace_invalid_parameters){
+	size_t size;
+	const void *region = fake_trace_storage(&size);
+
+	CHECK(powertask_trace_record(NULL, POWERTASK_TRACE_RESET, 0) < 0);
+	CHECK(powertask_trace_flush(NULL) < 0);
+	CHECK(powertask_trace_decode(NULL, size, decode_record, NULL) < 0);
+	CHECK(powertask_trace_decode(region, size, NULL, NULL) < 0);
+	CHECK(powertask_trace_decode(region, size, decode_record, NULL) < 0);
+	STRCMP_EQUAL("unknown", powertask_trace_event_name(0));
+	STRCMP_EQUAL("completed", powertask_trace_event_name(POWERTASK_TRACE_COMPLETED));
+}
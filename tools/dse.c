@@ -0,0 +1,549 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <powertask/scheduler.h>
+#include <powertask/storage.h>
+
+#if POWERTASK_CONFIG_CONST_TASKS || POWERTASK_CONFIG_STATIC_STATE
+#error "powertask_dse builds tasks at run time and runs schedulers in parallel: use the default profile"
+#endif
+
+#define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
+
+#define PI 3.14159265358979323846
+
+/** @brief Voltage (in mV) at which the harvester stops charging the capacitor. */
+#define MAX_VOLTAGE 3600
+
+/** @brief Voltage (in mV) below which the node browns out. */
+#define BROWNOUT_VOLTAGE 1800
+
+/** @brief Mean harvested energy per tick. */
+#define HARVEST_ENERGY 1.5
+
+/** @brief Energy spent per tick by a node that is on. */
+#define IDLE_ENERGY 0.05
+
+/** @brief Fraction of the stored energy lost per tick to capacitor leakage. */
+#define LEAKAGE 2e-5
+
+/** @brief Spread of the energy actually spent by an action around its mean cost. */
+#define COST_SPREAD 0.2
+
+/** @brief Period (in ticks) of the solar harvest trace. */
+#define SOLAR_PERIOD 2000
+
+/** @brief Probability of a harvest burst in a tick of the bursty trace. */
+#define BURST_PROBABILITY 0.05
+
+/** @brief Default number of simulated ticks. */
+#define DEFAULT_TICKS 10000
+
+/** @brief Default number of harvest trace seeds per configuration. */
+#define DEFAULT_SEEDS 4
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                      Workload                                                      */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+enum { TASK_SENSE, TASK_PROCESS, TASK_STORE, TASK_TRANSMIT, NUMBER_OF_TASKS };
+
+/** @brief Bits of the tasks completed in a round. */
+#define ALL_TASKS ((1U << NUMBER_OF_TASKS) - 1)
+
+/** @brief Size (in bytes) of the state of the workload. */
+#define STATE_SIZE POWERTASK_STATE_SIZE(NUMBER_OF_TASKS)
+
+static void action_sense(void);
+static void action_process(void);
+static void action_store(void);
+static void action_transmit(void);
+static bool after_sense(void);
+static bool after_process(void);
+
+/** @brief Task of the simulated workload */
+struct workload_task_s {
+    const char *name;        /**< Task name, also used for its id. */
+    double cost;             /**< Mean energy actually spent by the action. */
+    void (*action)(void);    /**< Action, spending the energy of the task. */
+    bool (*condition)(void); /**< Condition of the task. */
+};
+
+static const struct workload_task_s workload[NUMBER_OF_TASKS] = {
+    [TASK_SENSE]    = { "sense",    20.0,  action_sense,    POWERTASK_RUN_ALWAYS },
+    [TASK_PROCESS]  = { "process",  40.0,  action_process,  after_sense },
+    [TASK_STORE]    = { "store",    60.0,  action_store,    after_sense },
+    [TASK_TRANSMIT] = { "transmit", 300.0, action_transmit, after_process },
+};
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Design space                                                    */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+enum { TRACE_CONSTANT, TRACE_SOLAR, TRACE_BURSTY, NUMBER_OF_TRACES };
+
+static const char *const trace_names[NUMBER_OF_TRACES] = { "constant", "solar", "bursty" };
+
+/** @brief Capacitances (in uF). */
+static const int capacitances[] = { 47, 100, 220, 470, 1000, 2200 };
+
+/** @brief Margins (in %) added to the mean cost of the tasks in their required energy. */
+static const int margins[] = { 0, 10, 25, 50 };
+
+/** @brief Voltages (in mV) at which the node turns on. */
+static const int turn_on_voltages[] = { 2400, 2800, 3200 };
+
+static const char *const order_names[] = { "pipeline", "cheapest", "costliest" };
+
+/** @brief Order in which the tasks are added to the scheduler. */
+static const int orders[][NUMBER_OF_TASKS] = {
+    { TASK_SENSE, TASK_PROCESS, TASK_TRANSMIT, TASK_STORE },
+    { TASK_SENSE, TASK_PROCESS, TASK_STORE, TASK_TRANSMIT },
+    { TASK_TRANSMIT, TASK_STORE, TASK_PROCESS, TASK_SENSE },
+};
+
+/** @brief Point of the design space */
+struct config_s {
+    int trace;           /**< Harvest trace. */
+    int capacitance;     /**< Capacitance (in uF). */
+    int margin;          /**< Required energy margin (in %). */
+    int turn_on_voltage; /**< Turn-on voltage (in mV). */
+    int order;           /**< Task order. */
+};
+
+#define NUMBER_OF_CONFIGS ((int)(NUMBER_OF_TRACES * ARRAY_LENGTH(capacitances) * ARRAY_LENGTH(margins) * \
+                                 ARRAY_LENGTH(turn_on_voltages) * ARRAY_LENGTH(orders)))
+
+/** @brief Gets a point of the design space. Points of the same trace are contiguous. */
+static struct config_s get_config(int index){
+    struct config_s config;
+
+    config.order = index % ARRAY_LENGTH(orders);
+    index /= ARRAY_LENGTH(orders);
+    config.turn_on_voltage = turn_on_voltages[index % ARRAY_LENGTH(turn_on_voltages)];
+    index /= ARRAY_LENGTH(turn_on_voltages);
+    config.margin = margins[index % ARRAY_LENGTH(margins)];
+    index /= ARRAY_LENGTH(margins);
+    config.capacitance = capacitances[index % ARRAY_LENGTH(capacitances)];
+    index /= ARRAY_LENGTH(capacitances);
+    config.trace = index;
+
+    return config;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                     Simulation                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief State of one simulated node */
+struct simulation_s {
+    struct config_s config;                 /**< Simulated point of the design space. */
+    double energy;                          /**< Energy stored in the capacitor. */
+    double brownout_energy;                 /**< Energy at the brownout voltage. */
+    bool on;                                /**< Indicates if the node is powered. */
+    uint32_t random;                        /**< State of the pseudo-random generator. */
+    long solar_phase;                       /**< Offset (in ticks) of the solar trace. */
+    long tick;                              /**< Virtual time. */
+    long round_start;                       /**< Tick at which the current round started. */
+    unsigned round_done;                    /**< Tasks completed in the current round. */
+    long rounds;                            /**< Rounds completed. */
+    long latency;                           /**< Sum of the duration of the completed rounds. */
+    long brownouts;                         /**< Number of times the node lost power. */
+    uint8_t storage[STATE_SIZE];            /**< Non-volatile storage of the node. */
+    size_t storage_used;                    /**< Bytes used in storage. */
+    powertask_energy_source_t energy_source;
+    powertask_scheduler sched;
+    powertask_task tasks[NUMBER_OF_TASKS];
+    powertask_task *list_of_tasks[NUMBER_OF_TASKS];
+    powertask_count_t tasks_by_cost[NUMBER_OF_TASKS];
+    uint32_t state_buffer[STATE_SIZE / sizeof(uint32_t)];
+};
+
+/** @brief Result of a simulation, or mean of the results of a configuration */
+struct result_s {
+    double throughput; /**< Rounds completed per 1000 ticks. */
+    double latency;    /**< Mean ticks per round. Infinite if no round was completed. */
+    double brownouts;  /**< Number of brownouts, each followed by a reboot. */
+};
+
+/** @brief Simulation run by the calling thread. The library hooks have no context, so they use this one. */
+static _Thread_local struct simulation_s *current;
+
+static double energy_at(int capacitance, int voltage){
+    return (double)capacitance * voltage * voltage / 2000000.0;
+}
+
+/** @brief Uniform pseudo-random number in [0, 1). Deterministic for a given seed. */
+static double next_random(struct simulation_s *sim){
+    sim->random = sim->random * 1664525U + 1013904223U;
+    return (sim->random >> 8) / 16777216.0;
+}
+
+static double get_harvest(struct simulation_s *sim){
+    double power;
+
+    switch(sim->config.trace){
+    case TRACE_SOLAR:
+        /* Half-wave sine with the same mean as the other traces. */
+        power = sin(2.0 * PI * (sim->tick + sim->solar_phase) / SOLAR_PERIOD);
+        return power > 0 ? HARVEST_ENERGY * PI * power : 0;
+    case TRACE_BURSTY:
+        return next_random(sim) < BURST_PROBABILITY ? HARVEST_ENERGY / BURST_PROBABILITY : 0;
+    default:
+        return HARVEST_ENERGY;
+    }
+}
+
+static void power_off(struct simulation_s *sim){
+    sim->on = false;
+    sim->brownouts++;
+}
+
+/** @brief Spends the energy of a task. The task only completes if the node survives it. */
+static void run_action(int task){
+    struct simulation_s *sim = current;
+
+    sim->energy -= workload[task].cost * (1.0 - COST_SPREAD + 2.0 * COST_SPREAD * next_random(sim));
+
+    if(sim->energy < sim->brownout_energy){
+        /* Nothing else runs and the state of this run is not stored. */
+        power_off(sim);
+        return;
+    }
+
+    sim->round_done |= 1U << task;
+
+    if(sim->round_done == ALL_TASKS){
+        sim->rounds++;
+        sim->latency += sim->tick - sim->round_start;
+        sim->round_start = sim->tick;
+        sim->round_done = 0;
+    }
+}
+
+static void action_sense(void){ run_action(TASK_SENSE); }
+static void action_process(void){ run_action(TASK_PROCESS); }
+static void action_store(void){ run_action(TASK_STORE); }
+static void action_transmit(void){ run_action(TASK_TRANSMIT); }
+
+static bool after_sense(void){ return current->tasks[TASK_SENSE].complete; }
+static bool after_process(void){ return current->tasks[TASK_PROCESS].complete; }
+
+/** @brief Voltage on the capacitor, as measured by the node. A node that is off measures nothing. */
+static int get_voltage(void){
+    struct simulation_s *sim = current;
+
+    if(!sim->on || sim->energy <= 0){
+        return 0;
+    }
+
+    return (int)sqrt(sim->energy * 2000000.0 / sim->config.capacitance);
+}
+
+int powertask_storage_save(void *data_to_store, size_t size_of_data){
+    /* The node lost power before the write. */
+    if(!current->on){
+        return -EIO;
+    }
+
+    if(size_of_data > sizeof(current->storage)){
+        return -EINVAL;
+    }
+
+    memcpy(current->storage, data_to_store, size_of_data);
+    current->storage_used = size_of_data;
+
+    return 0;
+}
+
+int powertask_storage_load(void *buffer, size_t size_of_buffer){
+    if(current->storage_used == 0){
+        return -ENOENT;
+    }
+
+    if(size_of_buffer < current->storage_used){
+        return -ENOSPC;
+    }
+
+    memcpy(buffer, current->storage, current->storage_used);
+
+    return 0;
+}
+
+#ifdef POWERTASK_CONFIG_TRACE
+int powertask_storage_trace_write(size_t offset, const void *data, size_t size){
+    (void)offset;
+    (void)data;
+    (void)size;
+
+    return 0;
+}
+
+int powertask_storage_trace_read(size_t offset, void *buffer, size_t size){
+    (void)offset;
+    (void)buffer;
+    (void)size;
+
+    return -ENOENT;
+}
+#endif
+
+static void init_simulation(struct simulation_s *sim, const struct config_s *config, uint32_t seed){
+    const int *order = orders[config->order];
+
+    memset(sim, 0, sizeof(*sim));
+
+    sim->config = *config;
+    sim->brownout_energy = energy_at(config->capacitance, BROWNOUT_VOLTAGE);
+    sim->random = seed * 2654435761U + 1U;
+    sim->solar_phase = (long)(next_random(sim) * SOLAR_PERIOD);
+
+    sim->energy_source = (powertask_energy_source_t){
+        .capacitance = config->capacitance,
+        .get_voltage = get_voltage,
+    };
+
+    sim->sched = (powertask_scheduler){
+        .list_of_tasks = sim->list_of_tasks,
+        ._list_of_tasks_len = NUMBER_OF_TASKS,
+        ._state_buffer = sim->state_buffer,
+        ._tasks_by_cost = sim->tasks_by_cost,
+    };
+
+    /* Tasks are admitted above the brownout energy, with a margin over their mean cost. */
+    for(int i = 0; i < NUMBER_OF_TASKS; i++){
+        const struct workload_task_s *task = &workload[order[i]];
+
+        sim->tasks[order[i]] = (powertask_task){
+            .action = task->action,
+            .condition = task->condition,
+            .required_energy = (int)ceil(sim->brownout_energy + task->cost * (100 + config->margin) / 100.0),
+            .id = powertask_task_id(task->name),
+        };
+        powertask_add(&sim->sched, &sim->tasks[order[i]]);
+    }
+}
+
+/** @brief Boots the node. RAM is lost, so the scheduler resumes from storage. */
+static void power_on(struct simulation_s *sim){
+    sim->on = true;
+
+    for(int i = 0; i < NUMBER_OF_TASKS; i++){
+        sim->tasks[i].complete = false;
+    }
+    powertask_invalidate_state(&sim->sched);
+}
+
+static struct result_s simulate(struct simulation_s *sim, const struct config_s *config, uint32_t seed, long ticks){
+    struct result_s result;
+    double turn_on_energy = energy_at(config->capacitance, config->turn_on_voltage);
+    double max_energy = energy_at(config->capacitance, MAX_VOLTAGE);
+
+    init_simulation(sim, config, seed);
+    current = sim;
+
+    for(sim->tick = 0; sim->tick < ticks; sim->tick++){
+        sim->energy += get_harvest(sim) - sim->energy * LEAKAGE;
+
+        if(sim->energy > max_energy){
+            sim->energy = max_energy;
+        }
+
+        if(!sim->on){
+            if(sim->energy < turn_on_energy){
+                continue;
+            }
+            power_on(sim);
+        }
+
+        sim->energy -= IDLE_ENERGY;
+
+        if(sim->energy < sim->brownout_energy){
+            power_off(sim);
+            continue;
+        }
+
+        powertask_run_scheduler(&sim->sched, &sim->energy_source);
+    }
+
+    current = NULL;
+
+    result.throughput = sim->rounds * 1000.0 / ticks;
+    result.latency = sim->rounds > 0 ? (double)sim->latency / sim->rounds : INFINITY;
+    result.brownouts = sim->brownouts;
+
+    return result;
+}
+
+/* ------------------------------------------------------------------------------------------------------------------ */
+/*                                                    Exploration                                                     */
+/* ------------------------------------------------------------------------------------------------------------------ */
+
+/** @brief Simulations shared by the worker threads */
+struct exploration_s {
+    long ticks;               /**< Simulated ticks per simulation. */
+    int seeds;                /**< Harvest trace seeds per configuration. */
+    int next;                 /**< Next simulation to be run. */
+    struct result_s *results; /**< Result of each simulation, by configuration and seed. */
+};
+
+static void *run_worker(void *arg){
+    struct exploration_s *exploration = arg;
+    struct simulation_s *sim = malloc(sizeof(*sim));
+    struct config_s config;
+    int total = NUMBER_OF_CONFIGS * exploration->seeds;
+    int i;
+
+    if(sim == NULL){
+        return NULL;
+    }
+
+    /* Results only depend on the configuration and seed, not on the thread running them. */
+    while((i = __atomic_fetch_add(&exploration->next, 1, __ATOMIC_RELAXED)) < total){
+        config = get_config(i / exploration->seeds);
+        exploration->results[i] = simulate(sim, &config, (uint32_t)(i % exploration->seeds), exploration->ticks);
+    }
+
+    free(sim);
+    return NULL;
+}
+
+/** @brief Checks if result a is at least as good as b on every objective and better on one. */
+static bool dominates(const struct result_s *a, const struct result_s *b){
+    if(a->throughput < b->throughput || a->latency > b->latency || a->brownouts > b->brownouts){
+        return false;
+    }
+
+    return a->throughput > b->throughput || a->latency < b->latency || a->brownouts < b->brownouts;
+}
+
+static void print_config(const struct config_s *config, const struct result_s *result){
+    printf("%-9s %7d %9d %9d %-10s %12.2f %14.1f %9.2f\n",
+           trace_names[config->trace], config->capacitance, config->margin, config->turn_on_voltage,
+           order_names[config->order], result->throughput, result->latency, result->brownouts);
+}
+
+static void print_results(const struct result_s *means, bool print_all){
+    const int per_trace = NUMBER_OF_CONFIGS / NUMBER_OF_TRACES;
+    struct config_s config;
+    bool dominated;
+
+    printf("%-9s %7s %9s %9s %-10s %12s %14s %9s\n",
+           "trace", "cap(uF)", "margin(%)", "v_on(mV)", "order", "rounds/kt", "latency(t)", "brownouts");
+
+    for(int i = 0; i < NUMBER_OF_CONFIGS; i++){
+        /* The harvest trace is the environment, not a design choice: fronts are per trace. */
+        int first = i - i % per_trace;
+
+        dominated = means[i].throughput == 0;
+
+        for(int j = first; j < first + per_trace && !dominated && !print_all; j++){
+            dominated = dominates(&means[j], &means[i]);
+        }
+
+        if(!dominated || print_all){
+            config = get_config(i);
+            print_config(&config, &means[i]);
+        }
+    }
+}
+
+/**
+ * @brief Explores the design space of a scheduler configuration
+ *
+ * @details Simulates a sense/process/store/transmit workload on an energy
+ * harvesting node, in virtual time, for every combination of capacitance,
+ * required energy margin, turn-on voltage and task order, against several
+ * harvest traces. Each simulation runs the scheduler in-process with its own
+ * storage and energy source. Prints the Pareto front of throughput, round
+ * latency and brownouts for each harvest trace.
+ *
+ * Usage: powertask_dse [-j threads] [-t ticks] [-s seeds] [-a]
+ */
+int main(int argc, char **argv){
+    struct exploration_s exploration = {
+        .ticks = DEFAULT_TICKS,
+        .seeds = DEFAULT_SEEDS,
+    };
+    struct result_s *means;
+    pthread_t *threads;
+    struct timespec start, end;
+    long number_of_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    long started = 0;
+    bool print_all = false;
+    int opt;
+
+    while((opt = getopt(argc, argv, "j:t:s:a")) != -1){
+        switch(opt){
+        case 'j': number_of_threads = atol(optarg); break;
+        case 't': exploration.ticks = atol(optarg); break;
+        case 's': exploration.seeds = atoi(optarg); break;
+        case 'a': print_all = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-j threads] [-t ticks] [-s seeds] [-a]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(number_of_threads < 1 || exploration.ticks < 1 || exploration.seeds < 1){
+        fprintf(stderr, "threads, ticks and seeds must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    exploration.results = calloc((size_t)NUMBER_OF_CONFIGS * exploration.seeds, sizeof(struct result_s));
+    means = calloc(NUMBER_OF_CONFIGS, sizeof(struct result_s));
+    threads = calloc(number_of_threads, sizeof(pthread_t));
+
+    if(exploration.results == NULL || means == NULL || threads == NULL){
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* Workers share the remaining simulations, so fewer threads only take longer. */
+    while(started < number_of_threads && pthread_create(&threads[started], NULL, run_worker, &exploration) == 0){
+        started++;
+    }
+
+    if(started == 0){
+        fprintf(stderr, "failed to start threads\n");
+        return EXIT_FAILURE;
+    }
+
+    for(long i = 0; i < started; i++){
+        pthread_join(threads[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for(int i = 0; i < NUMBER_OF_CONFIGS; i++){
+        for(int seed = 0; seed < exploration.seeds; seed++){
+            const struct result_s *result = &exploration.results[i * exploration.seeds + seed];
+
+            means[i].throughput += result->throughput / exploration.seeds;
+            means[i].latency += result->latency / exploration.seeds;
+            means[i].brownouts += result->brownouts / exploration.seeds;
+        }
+    }
+
+    print_results(means, print_all);
+
+    fprintf(stderr, "%d simulations of %ld ticks in %.2f s on %ld threads\n",
+            NUMBER_OF_CONFIGS * exploration.seeds, exploration.ticks,
+            (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, started);
+
+    free(threads);
+    free(means);
+    free(exploration.results);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <powertask/fleet.h>
+
+#define ARRAY_LENGTH(x) (sizeof(x) / sizeof((x)[0]))
+
+/** @brief Default number of simulated nodes. */
+#define DEFAULT_NODES 20000
+
+/** @brief Default number of simulated steps. */
+#define DEFAULT_STEPS 1000
+
+/** @brief Steps of harvest generated per node. The harvest repeats after them. */
+#define HARVEST_STEPS 64
+
+/** @brief Maximum harvest of a node in one step. */
+#define MAX_HARVEST 40
+
+/** @brief Energy stored by a full node. */
+#define MAX_ENERGY 600
+
+/** @brief Spread (in %) of the cost of the tasks between nodes. */
+#define COST_SPREAD 20
+
+/** @brief Sense, filter, log and transmit pipeline. Some tasks spend more than their required energy. */
+static const powertask_fleet_task_t tasks[] = {
+    { .required_energy = 20,  .cost = 18 },
+    { .required_energy = 15,  .cost = 15,  .wait_for = 1U << 0 },
+    { .required_energy = 40,  .cost = 35,  .wait_for = 1U << 1 },
+    { .required_energy = 60,  .cost = 70,  .wait_for = 1U << 1 },
+    { .required_energy = 25,  .cost = 22 },
+    { .required_energy = 30,  .cost = 30,  .wait_for = 1U << 4 },
+    { .required_energy = 80,  .cost = 75,  .wait_for = 1U << 2 },
+    { .required_energy = 300, .cost = 280, .wait_for = (1U << 2) | (1U << 5) },
+};
+
+/** @brief Uniform pseudo-random number in [0, range). */
+static int next_random(unsigned int *state, int range){
+    *state = *state * 1664525U + 1013904223U;
+    return (int)((*state >> 8) % (unsigned int)range);
+}
+
+static void *allocate(size_t count, size_t size){
+    void *memory = calloc(count, size);
+
+    if(memory == NULL){
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+/**
+ * @brief Measures the throughput of the fleet simulation
+ * 
+ * @details Simulates a fleet running an 8 task pipeline, each node with its own
+ * harvest trace and task costs, and reports node-steps per second. Build with
+ * optimizations (e.g. CMAKE_BUILD_TYPE=Release) so that the steps are
+ * vectorized.
+ * 
+ * Usage: powertask_fleet_bench [-n nodes] [-s steps] [-l learning shift]
+ */
+int main(int argc, char **argv){
+    powertask_fleet_t fleet = {
+        .tasks = tasks,
+        .number_of_tasks = ARRAY_LENGTH(tasks),
+        .number_of_nodes = DEFAULT_NODES,
+        .max_energy = MAX_ENERGY,
+    };
+    long steps = DEFAULT_STEPS;
+    unsigned int random = 1;
+    int32_t *harvest;
+    struct timespec start, end;
+    double seconds;
+    long executed_tasks = 0;
+    unsigned long rounds = 0;
+    unsigned long brownouts = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:l:")) != -1){
+        switch(opt){
+        case 'n': fleet.number_of_nodes = atoi(optarg); break;
+        case 's': steps = atol(optarg); break;
+        case 'l': fleet.learning_shift = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n nodes] [-s steps] [-l learning shift]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(fleet.number_of_nodes < 1 || steps < 1){
+        fprintf(stderr, "nodes and steps must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    if(fleet.learning_shift < 0 || fleet.learning_shift > POWERTASK_FLEET_MAX_LEARNING_SHIFT){
+        fprintf(stderr, "learning shift must be between 0 and %d\n", POWERTASK_FLEET_MAX_LEARNING_SHIFT);
+        return EXIT_FAILURE;
+    }
+
+    const size_t nodes = fleet.number_of_nodes;
+    const size_t elements = nodes * ARRAY_LENGTH(tasks);
+
+    fleet.energy = allocate(nodes, sizeof(int32_t));
+    fleet.complete = allocate(nodes, sizeof(uint32_t));
+    fleet.cost = allocate(elements, sizeof(int32_t));
+    fleet.learned_cost = allocate(elements, sizeof(int32_t));
+    fleet.rounds = allocate(nodes, sizeof(uint32_t));
+    fleet.brownouts = allocate(nodes, sizeof(uint32_t));
+    fleet._stored = allocate(nodes, sizeof(uint32_t));
+    harvest = allocate(nodes * HARVEST_STEPS, sizeof(int32_t));
+
+    if(powertask_fleet_init(&fleet) < 0){
+        fprintf(stderr, "invalid fleet\n");
+        return EXIT_FAILURE;
+    }
+
+    for(size_t i = 0; i < elements; i++){
+        fleet.cost[i] += fleet.cost[i] * (next_random(&random, 2 * COST_SPREAD + 1) - COST_SPREAD) / 100;
+    }
+
+    for(size_t i = 0; i < nodes * HARVEST_STEPS; i++){
+        harvest[i] = next_random(&random, MAX_HARVEST + 1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(long step = 0; step < steps; step++){
+        executed_tasks += powertask_fleet_step(&fleet, &harvest[(step % HARVEST_STEPS) * nodes]);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for(size_t node = 0; node < nodes; node++){
+        rounds += fleet.rounds[node];
+        brownouts += fleet.brownouts[node];
+    }
+
+    printf("nodes:            %zu\n", nodes);
+    printf("steps:            %ld\n", steps);
+    printf("tasks executed:   %ld\n", executed_tasks);
+    printf("rounds per node:  %.2f\n", (double)rounds / nodes);
+    printf("brownouts:        %lu\n", brownouts);
+    printf("node-steps/s:     %.3g\n", nodes * steps / seconds);
+
+    free(harvest);
+    free(fleet._stored);
+    free(fleet.brownouts);
+    free(fleet.rounds);
+    free(fleet.learned_cost);
+    free(fleet.cost);
+    free(fleet.complete);
+    free(fleet.energy);
+
+    return EXIT_SUCCESS;
+}
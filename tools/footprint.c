@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <powertask/scheduler.h>
+
+/** @brief Number of tasks reported if none is given. */
+#define DEFAULT_NUMBER_OF_TASKS 16
+
+/**
+ * @brief Reports the RAM used by the scheduler data structures
+ * 
+ * @details Sizes are those of the profile the library was built with, for the
+ * toolchain building this tool. Use the target toolchain (or the
+ * POWERTASK_*_SIZE macros in the application) for target sizes.
+ * 
+ * Usage: powertask_footprint [number of tasks]
+ */
+int main(int argc, char **argv){
+    int number_of_tasks = DEFAULT_NUMBER_OF_TASKS;
+
+    if(argc > 2){
+        fprintf(stderr, "usage: %s [number of tasks]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(argc == 2){
+        number_of_tasks = atoi(argv[1]);
+    }
+
+    if(number_of_tasks < 0 || number_of_tasks > POWERTASK_CONFIG_MAX_TASKS){
+        fprintf(stderr, "number of tasks must be between 0 and %d\n", POWERTASK_CONFIG_MAX_TASKS);
+        return EXIT_FAILURE;
+    }
+
+#ifdef POWERTASK_CONFIG_MINIMAL
+    printf("profile:          minimal\n");
+#else
+    printf("profile:          default\n");
+#endif
+    printf("task:             %zu bytes\n", (size_t)POWERTASK_TASK_RAM_SIZE);
+#if POWERTASK_CONFIG_CONST_TASKS
+    printf("task description: %zu bytes (const)\n", sizeof(powertask_task_info));
+#endif
+    printf("resource:         %zu bytes\n", sizeof(powertask_resource));
+    printf("scheduler:        %zu bytes (%d tasks)\n", (size_t)POWERTASK_SCHEDULER_RAM_SIZE(number_of_tasks), number_of_tasks);
+    printf("total:            %zu bytes\n",
+           (size_t)POWERTASK_SCHEDULER_RAM_SIZE(number_of_tasks) + number_of_tasks * POWERTASK_TASK_RAM_SIZE);
+    printf("state buffer:     %zu bytes (in the scheduler)\n", (size_t)POWERTASK_STATE_SIZE(number_of_tasks));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,282 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <powertask/scheduler.h>
+#include <powertask/storage.h>
+#include <powertask/port/linux.h>
+
+/** @brief Default duration (in ms) of each run. */
+#define DEFAULT_DURATION 2000
+
+/** @brief Default energy (in uJ) harvested every millisecond. */
+#define DEFAULT_HARVEST 20
+
+/** @brief Capacitance (in uF) of the simulated energy source. */
+#define CAPACITANCE 100
+
+/** @brief Energy (in uJ) stored at the highest voltage of the simulated energy source. */
+#define MAX_ENERGY 1250
+
+/** @brief Period (in ms) of the polling loop, and idle timeout of the run forever loop. */
+#define POLL_PERIOD 1
+
+/** @brief Energy (in uJ) stored in the simulated energy source. */
+static atomic_int energy;
+
+/** @brief Serializes the changes of the stored energy. */
+static pthread_mutex_t energy_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Voltage reads, i.e. the conversions a node would pay for. */
+static atomic_long voltage_reads;
+
+/** @brief Number of executed tasks. */
+static long executed_tasks;
+
+/** @brief Number of times the loop went to sleep. */
+static long sleeps;
+
+/** @brief Time when the current run ends. */
+static struct timespec deadline;
+
+/** @brief Indicates if the harvester thread should keep running. */
+static atomic_bool harvesting;
+
+/** @brief Energy (in uJ) harvested every millisecond. */
+static int harvest = DEFAULT_HARVEST;
+
+static int voltage_at(int stored){
+    return (int)sqrt(stored * 2000000.0 / CAPACITANCE);
+}
+
+static int get_voltage(void){
+    atomic_fetch_add(&voltage_reads, 1);
+    return voltage_at(atomic_load(&energy));
+}
+
+/**
+ * @brief Changes the stored energy and reports the new voltage, as a comparator would see it
+ *
+ * @details Both happen under a lock, so that the port never keeps a voltage older than the stored energy, which would
+ * make it wake up the loop again and again until the next report.
+ */
+static void charge(int amount){
+    int stored;
+
+    pthread_mutex_lock(&energy_lock);
+
+    stored = atomic_load(&energy) + amount;
+    atomic_store(&energy, stored < MAX_ENERGY ? stored : MAX_ENERGY);
+    powertask_linux_notify_voltage(voltage_at(atomic_load(&energy)));
+
+    pthread_mutex_unlock(&energy_lock);
+}
+
+static void spend(int cost){
+    charge(-cost);
+    executed_tasks++;
+}
+
+static void sense(void){ spend(150); }
+static void process(void){ spend(300); }
+static void transmit(void){ spend(900); }
+
+POWERTASK_DECLARE(sense);
+POWERTASK_DECLARE(process);
+POWERTASK_DECLARE(transmit);
+
+static powertask_energy_source_t energy_src = {
+    .capacitance = CAPACITANCE,
+    .get_voltage = get_voltage,
+};
+
+static uint8_t storage[256];
+static size_t storage_used;
+
+int powertask_storage_save(void *data_to_store, size_t size_of_data){
+    if(size_of_data > sizeof(storage)){
+        return -ENOSPC;
+    }
+
+    memcpy(storage, data_to_store, size_of_data);
+    storage_used = size_of_data;
+
+    return 0;
+}
+
+int powertask_storage_load(void *buffer, size_t size_of_buffer){
+    if(storage_used == 0){
+        return -ENOENT;
+    }
+
+    if(size_of_buffer < storage_used){
+        return -ENOSPC;
+    }
+
+    memcpy(buffer, storage, storage_used);
+
+    return 0;
+}
+
+#ifdef POWERTASK_CONFIG_TRACE
+int powertask_storage_trace_write(size_t offset, const void *data, size_t size){
+    (void)offset;
+    (void)data;
+    (void)size;
+
+    return 0;
+}
+
+int powertask_storage_trace_read(size_t offset, void *buffer, size_t size){
+    (void)offset;
+    (void)buffer;
+    (void)size;
+
+    return -ENOENT;
+}
+#endif
+
+static bool before_deadline(void){
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec < deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec < deadline.tv_nsec);
+}
+
+/** @brief Charges the energy source every millisecond and reports its voltage to the port. */
+static void *run_harvester(void *arg){
+    const struct timespec period = { .tv_nsec = 1000000 };
+
+    (void)arg;
+
+    while(atomic_load(&harvesting)){
+        nanosleep(&period, NULL);
+        charge(harvest);
+    }
+
+    return NULL;
+}
+
+static powertask_platform_t platform;
+
+static void counting_sleep(void){
+    sleeps++;
+    platform.sleep();
+}
+
+/** @brief Loop most applications write: one pass per poll period. */
+static void run_polling(powertask_scheduler *sched){
+    while(before_deadline()){
+        if(powertask_run_scheduler(sched, &energy_src) > 0){
+            continue;
+        }
+
+        platform.set_timer_wakeup(POLL_PERIOD);
+        counting_sleep();
+    }
+}
+
+static void run_forever(powertask_scheduler *sched){
+    powertask_platform_t counting_platform = platform;
+
+    counting_platform.sleep = counting_sleep;
+    counting_platform.keep_running = before_deadline;
+
+    powertask_run_forever(sched, &energy_src, &counting_platform);
+}
+
+/** @brief Runs a loop for the duration, from a discharged node, and prints what it cost. */
+static void measure(const char *name, void (*loop)(powertask_scheduler *), powertask_scheduler *sched,
+                    long duration){
+    task_sense.complete = false;
+    task_process.complete = false;
+    task_transmit.complete = false;
+    powertask_invalidate_state(sched);
+    storage_used = 0;
+
+    charge(-atomic_load(&energy));
+    atomic_store(&voltage_reads, 0);
+    executed_tasks = 0;
+    sleeps = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += duration / 1000;
+    deadline.tv_nsec += (duration % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000){
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    loop(sched);
+
+    printf("%-12s %10ld %14ld %10ld\n", name, executed_tasks, atomic_load(&voltage_reads), sleeps);
+}
+
+/**
+ * @brief Compares the run forever loop with a polling loop
+ *
+ * @details Runs a sense/process/transmit workload with the Linux reference
+ * port, first with a loop running a pass every poll period, then with
+ * powertask_run_forever(). A harvester thread charges the energy source every
+ * millisecond. Reports the executed tasks, the voltage reads, which a node
+ * pays for with ADC conversions, and the sleeps, i.e. the wakeups.
+ *
+ * Usage: powertask_run_forever_bench [-d duration in ms] [-e harvest per ms]
+ */
+int main(int argc, char **argv){
+    long duration = DEFAULT_DURATION;
+    pthread_t harvester;
+    int opt;
+
+    POWERTASK_INIT(scheduler, 3);
+    POWERTASK_TASK(scheduler, sense, sense, POWERTASK_RUN_ALWAYS, 200);
+    POWERTASK_TASK(scheduler, process, process, POWERTASK_RUN_ALWAYS, 350);
+    POWERTASK_TASK(scheduler, transmit, transmit, POWERTASK_RUN_ALWAYS, 1000);
+
+    while((opt = getopt(argc, argv, "d:e:")) != -1){
+        switch(opt){
+        case 'd': duration = atol(optarg); break;
+        case 'e': harvest = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-d duration in ms] [-e harvest per ms]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(duration < 1 || harvest < 1){
+        fprintf(stderr, "duration and harvest must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    if(powertask_linux_init(&platform) < 0){
+        fprintf(stderr, "failed to initialize the Linux port\n");
+        return EXIT_FAILURE;
+    }
+
+    platform.idle_timeout = POLL_PERIOD;
+
+    atomic_store(&harvesting, true);
+    if(pthread_create(&harvester, NULL, run_harvester, NULL) != 0){
+        fprintf(stderr, "failed to start the harvester\n");
+        powertask_linux_deinit();
+        return EXIT_FAILURE;
+    }
+
+    printf("%-12s %10s %14s %10s\n", "loop", "tasks", "voltage reads", "sleeps");
+    measure("polling", run_polling, &scheduler, duration);
+    measure("run_forever", run_forever, &scheduler, duration);
+
+    atomic_store(&harvesting, false);
+    pthread_join(harvester, NULL);
+    powertask_linux_deinit();
+
+    return EXIT_SUCCESS;
+}
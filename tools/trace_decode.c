@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <powertask/trace.h>
+#include <powertask/scheduler.h>
+
+/** @brief Maximum size of a trace region dump. */
+#define MAX_REGION_SIZE (1024 * 1024)
+
+/** @brief Timeline being printed */
+struct timeline_s {
+    int position;        /**< Position of the next record. */
+    char **task_names;   /**< Names of the tasks, to be matched with the recorded ids. */
+    int number_of_names; /**< Number of task names. */
+};
+
+/** @brief Gets the name of a recorded task id, if it was given. */
+static const char *get_task_name(struct timeline_s *timeline, uint32_t task){
+    for(int i = 0; i < timeline->number_of_names; i++){
+        if(POWERTASK_TRACE_TASK_ID(powertask_task_id(timeline->task_names[i])) == task){
+            return timeline->task_names[i];
+        }
+    }
+
+    return NULL;
+}
+
+/** @brief Prints one record of the timeline. */
+static int print_record(const powertask_trace_record_t *record, void *ctx){
+    struct timeline_s *timeline = ctx;
+    const char *name;
+
+    printf("%6d  %-18s", timeline->position++, powertask_trace_event_name(record->event));
+
+    if(record->task != POWERTASK_TRACE_NO_TASK){
+        name = get_task_name(timeline, record->task);
+
+        if(name != NULL){
+            printf("  %-16s", name);
+        } else {
+            printf("  task 0x%08x", (unsigned)record->task);
+        }
+    } else {
+        printf("  %-16s", "");
+    }
+
+    if(record->count > 1){
+        printf("  x%u", record->count);
+    }
+
+    printf("\n");
+    return 0;
+}
+
+/**
+ * @brief Decodes a dump of the trace region into a timeline
+ * 
+ * Usage: powertask_trace_decode <dump> [task names...]
+ * 
+ * Tasks are recorded by id. Records of the tasks named on the command line are
+ * printed with their name.
+ */
+int main(int argc, char **argv){
+    FILE *dump;
+    void *region;
+    size_t size;
+    struct timeline_s timeline = {
+        .task_names = &argv[2],
+        .number_of_names = argc - 2,
+    };
+
+    if(argc < 2){
+        fprintf(stderr, "usage: %s <trace region dump> [task names...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    dump = fopen(argv[1], "rb");
+    if(dump == NULL){
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    region = malloc(MAX_REGION_SIZE);
+    if(region == NULL){
+        fclose(dump);
+        return EXIT_FAILURE;
+    }
+
+    size = fread(region, 1, MAX_REGION_SIZE, dump);
+    fclose(dump);
+
+    if(powertask_trace_decode(region, size, print_record, &timeline) < 0){
+        fprintf(stderr, "%s: not a valid trace region\n", argv[1]);
+        free(region);
+        return EXIT_FAILURE;
+    }
+
+    free(region);
+    return EXIT_SUCCESS;
+}